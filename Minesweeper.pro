@@ -15,31 +15,13 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(minesweeper.pri)
+
 SOURCES += \
-    cell.cpp \
-    gameboard.cpp \
-    main.cpp \
-    mainwindow.cpp \
-    minefielddelegate.cpp \
-    minefieldmodel.cpp \
-    settingsdialog.cpp
-
-HEADERS += \
-    cell.h \
-    gameboard.h \
-    mainwindow.h \
-    minefielddelegate.h \
-    minefieldmodel.h \
-    settingsdialog.h
-
-FORMS += \
-    mainwindow.ui \
-    settingsdialog.ui
+    main.cpp
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
-RESOURCES += \
-    resources.qrc
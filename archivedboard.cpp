@@ -0,0 +1,148 @@
+#include "archivedboard.h"
+#include "minefieldmodel.h"
+#include <algorithm>
+
+
+ArchivedBoard::ArchivedBoard() : rows(0), columns(0), mineCount(0), won(false), boardHash(0)
+{
+}
+
+ArchivedBoard::ArchivedBoard(int rows, int columns, const QVector<Cell> &cells, const BoardTopology &topology, bool won, quint64 boardHash) :
+    rows(rows), columns(columns), mineCount(0), won(won), boardHash(boardHash), topology(topology.clone())
+{
+    //One pass over the board, closing a run whenever a row leaves the opened state
+    rowRuns.reserve(rows + 1);
+    for(int i = 0; i < rows; ++i) {
+        rowRuns.push_back(runStarts.size());
+        int runStart = -1;
+
+        for(int j = 0; j < columns; ++j) {
+            int cell = i * columns + j;
+            bool opened = cells[cell].isStatusFlagSet(Cell::Opened);
+            if(opened && runStart < 0) {
+                runStart = j;
+            } else if(!opened && runStart >= 0) {
+                runStarts.push_back(runStart);
+                runEnds.push_back(j);
+                runStart = -1;
+            }
+
+            //Row major scan keeps both lists sorted
+            if(cells[cell].isStatusFlagSet(Cell::HasMine)) mines.push_back(cell);
+            if(cells[cell].isStatusFlagSet(Cell::Flagged)) flags.push_back(cell);
+        }
+
+        if(runStart >= 0) {
+            runStarts.push_back(runStart);
+            runEnds.push_back(columns);
+        }
+    }
+    rowRuns.push_back(runStarts.size());
+    mineCount = mines.size();
+
+    runStarts.squeeze();
+    runEnds.squeeze();
+    mines.squeeze();
+    flags.squeeze();
+}
+
+int ArchivedBoard::rowCount() const
+{
+    return rows;
+}
+
+int ArchivedBoard::columnCount() const
+{
+    return columns;
+}
+
+int ArchivedBoard::getMineCount() const
+{
+    return mineCount;
+}
+
+bool ArchivedBoard::isWon() const
+{
+    return won;
+}
+
+quint64 ArchivedBoard::getBoardHash() const
+{
+    return boardHash;
+}
+
+bool ArchivedBoard::isOpened(int row, int col) const
+{
+    //Last run starting at or before col, opened if col falls before its end
+    const int *first = runStarts.constData() + rowRuns[row], *last = runStarts.constData() + rowRuns[row + 1];
+    const int *run = std::upper_bound(first, last, col);
+    if(run == first) return false;
+    return col < runEnds[(run - 1) - runStarts.constData()];
+}
+
+bool ArchivedBoard::hasMine(int row, int col) const
+{
+    return containsSorted(mines, row * columns + col);
+}
+
+bool ArchivedBoard::isFlagged(int row, int col) const
+{
+    return containsSorted(flags, row * columns + col);
+}
+
+int ArchivedBoard::minesAdjacent(int row, int col) const
+{
+    //Counts are not stored, work them out from the topology for the cells being looked at
+    QVector<int> neighbours;
+    topology->appendNeighbours(row, col, rows, columns, neighbours);
+
+    int count = 0;
+    for(int cell : neighbours) {
+        count += containsSorted(mines, cell);
+    }
+    return count;
+}
+
+qint64 ArchivedBoard::byteSize() const
+{
+    qint64 ints = rowRuns.capacity() + runStarts.capacity() + runEnds.capacity() + mines.capacity() + flags.capacity();
+    return static_cast<qint64>(sizeof(ArchivedBoard)) + ints * static_cast<qint64>(sizeof(int));
+}
+
+bool ArchivedBoard::containsSorted(const QVector<int> &list, int cell)
+{
+    return std::binary_search(list.constBegin(), list.constEnd(), cell);
+}
+
+ArchivedBoardModel::ArchivedBoardModel(const ArchivedBoard &board, QObject *parent) : QAbstractTableModel(parent),
+    board(board)
+{
+}
+
+int ArchivedBoardModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return board.rowCount();
+}
+
+int ArchivedBoardModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return board.columnCount();
+}
+
+QVariant ArchivedBoardModel::data(const QModelIndex &index, int role) const
+{
+    //Same roles as the live model so MinefieldDelegate paints it unchanged
+    if(role == MinefieldModel::OpenStatusRole) {
+        return board.isOpened(index.row(), index.column());
+    } else if(role == MinefieldModel::MineStatusRole) {
+        return board.hasMine(index.row(), index.column());
+    } else if(role == MinefieldModel::FlagStatusRole) {
+        return board.isFlagged(index.row(), index.column());
+    } else if(role == MinefieldModel::MineCountRole) {
+        return board.minesAdjacent(index.row(), index.column());
+    }
+
+    return QVariant();
+}
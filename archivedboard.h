@@ -0,0 +1,60 @@
+#ifndef ARCHIVEDBOARD_H
+#define ARCHIVEDBOARD_H
+
+#include <QAbstractTableModel>
+#include <QSharedPointer>
+#include <QVector>
+#include "cell.h"
+#include "boardtopology.h"
+
+//Read-only compressed form of a finished board, opened cells as runs per row
+//and mines and flags as sorted cell lists, queried without decompressing
+class ArchivedBoard
+{
+private:
+    int rows,
+        columns,
+        mineCount;
+    bool won;
+    quint64 boardHash;//Zobrist hash of the final position, equal hashes mean the same finished board
+
+    //Runs of row i are runStarts/runEnds[rowRuns[i]] up to rowRuns[i + 1], ends are exclusive
+    QVector<int> rowRuns,
+                 runStarts,
+                 runEnds;
+    QVector<int> mines,
+                 flags;
+    QSharedPointer<BoardTopology> topology;
+
+    static bool containsSorted(const QVector<int> &list, int cell);
+
+public:
+    ArchivedBoard();
+    ArchivedBoard(int rows, int columns, const QVector<Cell> &cells, const BoardTopology &topology, bool won, quint64 boardHash);
+    int rowCount() const;
+    int columnCount() const;
+    int getMineCount() const;
+    bool isWon() const;
+    quint64 getBoardHash() const;
+    bool isOpened(int row, int col) const;
+    bool hasMine(int row, int col) const;
+    bool isFlagged(int row, int col) const;
+    int minesAdjacent(int row, int col) const;
+    qint64 byteSize() const;
+};
+
+//Table model over an archived board so the normal view and delegate can render any viewport of it
+class ArchivedBoardModel : public QAbstractTableModel
+{
+    Q_OBJECT
+private:
+    ArchivedBoard board;
+
+public:
+    explicit ArchivedBoardModel(const ArchivedBoard &board, QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent) const override;
+    int columnCount(const QModelIndex &parent) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+};
+
+#endif // ARCHIVEDBOARD_H
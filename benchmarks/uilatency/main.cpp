@@ -0,0 +1,333 @@
+#include "mainwindow.h"
+#include "gameboard.h"
+#include "minefieldmodel.h"
+#include <QApplication>
+#include <QPushButton>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QTimer>
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+
+
+//Watches for the gameboard viewport finishing a paint pass
+class PaintProbe : public QObject
+{
+public:
+    bool painted = false;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if(event->type() == QEvent::Paint && watched->parent() != nullptr && watched->parent()->inherits("Gameboard")) {
+            painted = true;
+        }
+        return false;
+    }
+};
+
+struct BoardSize {
+    int rows,
+        cols;
+};
+
+//Presses that never settled are counted, not recorded as a timeout-length sample
+struct Samples {
+    QVector<double> times;
+    int timeouts = 0;
+
+    void add(double milliseconds)
+    {
+        if(milliseconds < 0) {
+            ++timeouts;
+        } else {
+            times.push_back(milliseconds);
+        }
+    }
+};
+
+static const int SETTLE_TIMEOUT_MS = 5000;
+
+static PaintProbe probe;
+static MainWindow *window = nullptr;
+static bool gameFinished = false;
+
+//Game over handling (statistics, archive, message box) is timed apart from the press that caused it
+static QElapsedTimer pressTimer;
+static bool timingPress = false;
+static qint64 gameOverAt = -1;
+static Samples gameOverSamples;
+
+static Gameboard *currentBoard()
+{
+    return window->findChild<Gameboard *>();
+}
+
+static MinefieldModel *currentModel()
+{
+    return qobject_cast<MinefieldModel *>(currentBoard()->model());
+}
+
+static void applySettings(int rows, int cols, int mines, bool forgiving = false)
+{
+    QSettings settings("Sebastian Games", "Minesweeper");
+    settings.beginGroup("userSettings");
+    settings.setValue("cellSize", 20);
+    settings.setValue("gameRows", rows);
+    settings.setValue("gameCols", cols);
+    settings.setValue("mineCount", mines);
+    settings.setValue("minBoardValue", 0);
+    settings.setValue("maxBoardValue", 0);
+    settings.setValue("difficulty", "Custom");
+    settings.setValue("forgiving", forgiving);
+    settings.endGroup();
+}
+
+//Process events until the board has painted and any streamed reveal is finished, false on timeout
+static bool settle()
+{
+    QElapsedTimer timeout;
+    timeout.start();
+    while(!probe.painted || currentModel()->isRevealPending()) {
+        if(timeout.elapsed() >= SETTLE_TIMEOUT_MS) {
+            qWarning("Board did not settle within %d ms", SETTLE_TIMEOUT_MS);
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    }
+    return true;
+}
+
+static void freshGame(int rows, int cols, int mines, bool forgiving = false)
+{
+    applySettings(rows, cols, mines, forgiving);
+    window->resetGame();
+    gameFinished = false;
+
+    //Note the time before MainWindow handles the result, slots run in connection order
+    MinefieldModel *model = currentModel();
+    QObject::disconnect(model, &MinefieldModel::gameOver, window, &MainWindow::stopGame);
+    QObject::connect(model, &MinefieldModel::gameOver, []() {
+        gameFinished = true;
+        if(timingPress) gameOverAt = pressTimer.nsecsElapsed();
+    });
+    QObject::connect(model, &MinefieldModel::gameOver, window, &MainWindow::stopGame);
+    probe.painted = false;
+    settle();
+}
+
+static QPoint cellCenter(int row, int col)
+{
+    Gameboard *board = currentBoard();
+    return board->visualRect(board->model()->index(row, col)).center();
+}
+
+//Time from delivering a press to the end of the paint it causes, or to the game ending if it did,
+//-1 when it never settled
+static double timedPress(QWidget *target, Qt::MouseButton button, const QPoint &pos)
+{
+    probe.painted = false;
+    gameOverAt = -1;
+    timingPress = true;
+    pressTimer.start();
+    QTest::mousePress(target, button, Qt::NoModifier, pos);
+    bool settled = settle();
+    qint64 elapsed = pressTimer.nsecsElapsed();
+    timingPress = false;
+    QTest::mouseRelease(target, button, Qt::NoModifier, pos);
+
+    if(gameOverAt < 0) return settled ? elapsed / 1e6 : -1;
+    gameOverSamples.add(settled ? (elapsed - gameOverAt) / 1e6 : -1);
+    return gameOverAt / 1e6;
+}
+
+static void untimedPress(Qt::MouseButton button, int row, int col)
+{
+    QWidget *viewport = currentBoard()->viewport();
+    QTest::mousePress(viewport, button, Qt::NoModifier, cellCenter(row, col));
+    QTest::mouseRelease(viewport, button, Qt::NoModifier, cellCenter(row, col));
+    probe.painted = false;
+    settle();
+}
+
+//Open numbered cell with at least one closed neighbour, or -1 when the board has none
+static int findChordCell(MinefieldModel *model, int rows, int cols)
+{
+    for(int i = 0; i < rows; ++i) {
+        for(int j = 0; j < cols; ++j) {
+            QModelIndex index = model->index(i, j);
+            if(!index.data(MinefieldModel::OpenStatusRole).toBool() || index.data(MinefieldModel::MineCountRole).toInt() == 0) continue;
+            for(int a = i - 1; a <= i + 1; ++a) {
+                for(int b = j - 1; b <= j + 1; ++b) {
+                    if(a < 0 || b < 0 || a >= rows || b >= cols) continue;
+                    if(!model->index(a, b).data(MinefieldModel::OpenStatusRole).toBool()) return i * cols + j;
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+//Closed mine next to an open number so a guess on it goes through the solver, else any closed mine,
+//or -1 when the board has none
+static int findGuessCell(MinefieldModel *model, int rows, int cols)
+{
+    int fallback = -1;
+    for(int i = 0; i < rows; ++i) {
+        for(int j = 0; j < cols; ++j) {
+            QModelIndex index = model->index(i, j);
+            if(index.data(MinefieldModel::OpenStatusRole).toBool() || !index.data(MinefieldModel::MineStatusRole).toBool()) continue;
+            if(fallback < 0) fallback = i * cols + j;
+            for(int a = i - 1; a <= i + 1; ++a) {
+                for(int b = j - 1; b <= j + 1; ++b) {
+                    if(a < 0 || b < 0 || a >= rows || b >= cols) continue;
+                    if(model->index(a, b).data(MinefieldModel::OpenStatusRole).toBool()) return i * cols + j;
+                }
+            }
+        }
+    }
+    return fallback;
+}
+
+//Mines below zero are left out, for scenarios mixing board densities
+static QJsonObject summarize(const QString &scenario, const BoardSize &size, int mines, const Samples &recorded)
+{
+    QVector<double> samples = recorded.times;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        if(samples.isEmpty()) return 0.0;
+        int rank = qBound(0, static_cast<int>(std::ceil(p * samples.size())) - 1, samples.size() - 1);
+        return samples[rank];
+    };
+
+    QJsonObject result({{"scenario", scenario},
+                        {"rows", size.rows},
+                        {"cols", size.cols},
+                        {"samples", static_cast<int>(samples.size())},
+                        {"timeouts", recorded.timeouts},
+                        {"p50_ms", percentile(0.50)},
+                        {"p99_ms", percentile(0.99)}});
+    if(mines >= 0) result.insert("mines", mines);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    //Headless by default so this runs on build machines
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QString outputPath = argc > 1 ? QString(argv[1]) : QString("uilatency.json");
+    int iterations = argc > 2 ? qMax(1, QString(argv[2]).toInt()) : 30;
+
+    //Keep user settings and statistics out of the benchmark, every run starts with an empty history
+    QTemporaryDir settingsDir;
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, settingsDir.path());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, settingsDir.path());
+
+    //Game over message boxes would block, close them as they appear
+    QTimer dialogCloser;
+    QObject::connect(&dialogCloser, &QTimer::timeout, []() {
+        if(QWidget *modal = QApplication::activeModalWidget()) modal->close();
+    });
+    dialogCloser.start(1);
+
+    app.installEventFilter(&probe);
+    applySettings(8, 10, 7);
+    MainWindow mainWindow(nullptr, settingsDir.filePath("statistics"));
+    window = &mainWindow;
+    mainWindow.show();
+    if(!QTest::qWaitForWindowExposed(&mainWindow)) {
+        qWarning("Window was never exposed");
+        return 1;
+    }
+    QPushButton *newGameButton = mainWindow.findChild<QPushButton *>("newGameButton");
+
+    //Presets up to the settings dialog maximum of 70 x 130
+    const QVector<BoardSize> sizes = {{8, 10}, {19, 26}, {40, 70}, {70, 130}};
+    QJsonArray results;
+
+    for(const BoardSize &size : sizes) {
+        int cells = size.rows * size.cols;
+        int denseMines = qMax(1, cells / 5), sparseMines = qMax(1, cells / 100);
+        int centerRow = size.rows / 2, centerCol = size.cols / 2;
+        Samples firstClick, floodFill, chord, flagSpam, reset, forgivingGuess;
+        gameOverSamples = Samples();
+
+        for(int iteration = 0; iteration < iterations; ++iteration) {
+            //First click on a normal density board
+            freshGame(size.rows, size.cols, denseMines);
+            firstClick.add(timedPress(currentBoard()->viewport(), Qt::LeftButton, cellCenter(centerRow, centerCol)));
+
+            //Chord an open number after flagging its mines, a finished board takes no input
+            MinefieldModel *model = currentModel();
+            int chordCell = gameFinished ? -1 : findChordCell(model, size.rows, size.cols);
+            if(chordCell >= 0) {
+                int row = chordCell / size.cols, col = chordCell % size.cols;
+                for(int a = row - 1; a <= row + 1; ++a) {
+                    for(int b = col - 1; b <= col + 1; ++b) {
+                        if(a < 0 || b < 0 || a >= size.rows || b >= size.cols) continue;
+                        QModelIndex index = model->index(a, b);
+                        if(index.data(MinefieldModel::MineStatusRole).toBool() && !index.data(MinefieldModel::FlagStatusRole).toBool()) {
+                            untimedPress(Qt::RightButton, a, b);
+                        }
+                    }
+                }
+                chord.add(timedPress(currentBoard()->viewport(), Qt::LeftButton, cellCenter(row, col)));
+            }
+
+            //Flag up to 50 closed cells as fast as possible
+            for(int i = 0, flagged = 0; i < cells && flagged < 50 && !gameFinished; ++i) {
+                int row = i / size.cols, col = i % size.cols;
+                if(currentModel()->index(row, col).data(MinefieldModel::OpenStatusRole).toBool()) continue;
+                flagSpam.add(timedPress(currentBoard()->viewport(), Qt::RightButton, cellCenter(row, col)));
+                ++flagged;
+            }
+
+            //Reset through the new game button
+            probe.painted = false;
+            QElapsedTimer timer;
+            timer.start();
+            QTest::mouseClick(newGameButton, Qt::LeftButton);
+            reset.add(settle() ? timer.nsecsElapsed() / 1e6 : -1);
+
+            //Large flood fill on a sparse board
+            freshGame(size.rows, size.cols, sparseMines);
+            floodFill.add(timedPress(currentBoard()->viewport(), Qt::LeftButton, cellCenter(centerRow, centerCol)));
+
+            //Guess onto a mine in forgiving mode, the solver looks for a layout with that cell safe
+            freshGame(size.rows, size.cols, denseMines, true);
+            untimedPress(Qt::LeftButton, centerRow, centerCol);
+            int guessCell = gameFinished ? -1 : findGuessCell(currentModel(), size.rows, size.cols);
+            if(guessCell >= 0) {
+                forgivingGuess.add(timedPress(currentBoard()->viewport(), Qt::LeftButton, cellCenter(guessCell / size.cols, guessCell % size.cols)));
+            }
+        }
+
+        results.append(summarize("first_click", size, denseMines, firstClick));
+        results.append(summarize("flood_fill", size, sparseMines, floodFill));
+        results.append(summarize("chord", size, denseMines, chord));
+        results.append(summarize("flag_spam", size, denseMines, flagSpam));
+        results.append(summarize("reset", size, denseMines, reset));
+        results.append(summarize("forgiving_guess", size, denseMines, forgivingGuess));
+        results.append(summarize("game_over", size, -1, gameOverSamples));
+    }
+
+    //Machine readable report
+    QFile output(outputPath);
+    if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Could not write %s", qPrintable(outputPath));
+        return 1;
+    }
+    QJsonObject report({{"platform", QGuiApplication::platformName()},
+                        {"iterations", iterations},
+                        {"results", results}});
+    output.write(QJsonDocument(report).toJson());
+    return 0;
+}
@@ -0,0 +1,14 @@
+# Input to paint latency benchmark, runs the real MainWindow on the offscreen platform
+# Usage: uilatency [output.json] [iterations]
+
+QT += core gui widgets testlib
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = uilatency
+
+include(../../minesweeper.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,247 @@
+#include "boardtopology.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+
+
+BoardTopology::~BoardTopology()
+{
+}
+
+int BoardTopology::layerCount() const
+{
+    //Flat boards are a single layer
+    return 1;
+}
+
+qint64 BoardTopology::compiledBytes(int rows, int columns) const
+{
+    //Upper bound from the largest neighbourhood, edge cells only ever have fewer
+    qint64 cells = static_cast<qint64>(rows) * columns;
+    return (cells + 1) * static_cast<qint64>(sizeof(qsizetype)) + cells * maxNeighbours() * static_cast<qint64>(sizeof(int));
+}
+
+bool BoardTopology::canCompile(int rows, int columns) const
+{
+    return compiledBytes(rows, columns) <= MAX_COMPILED_BYTES;
+}
+
+BoardTopology::Adjacency BoardTopology::compile(int rows, int columns) const
+{
+    //Callers check the size first, the bound also keeps every total inside qsizetype
+    Q_ASSERT(canCompile(rows, columns));
+
+    struct Band {
+        int firstRow,
+            lastRow;
+        qsizetype base;//Neighbours of every cell before this band
+    };
+
+    //Small boards in one go, large ones in bands of rows across the thread pool
+    QVector<Band> bands;
+    int bandRows = (static_cast<qint64>(rows) * columns < PARALLEL_COMPILE_THRESHOLD) ? qMax(1, rows) : COMPILE_BAND_ROWS;
+    for(int i = 0; i < rows; i += bandRows) {
+        bands.push_back({i, qMin(rows, i + bandRows), 0});
+    }
+    auto forEachBand = [&bands](const std::function<void(Band &)> &function) {
+        if(bands.size() == 1) {
+            function(bands.first());
+        } else {
+            QtConcurrent::blockingMap(bands, function);
+        }
+    };
+
+    //First pass only counts, so the final arrays are the only large allocation
+    forEachBand([this, rows, columns](Band &band) {
+        QVector<int> out;
+        for(int i = band.firstRow; i < band.lastRow; ++i) {
+            for(int j = 0; j < columns; ++j) {
+                out.clear();
+                appendNeighbours(i, j, rows, columns, out);
+                band.base += out.size();
+            }
+        }
+    });
+
+    qsizetype total = 0;
+    for(Band &band : bands) {
+        qsizetype count = band.base;
+        band.base = total;
+        total += count;
+    }
+
+    Adjacency adjacency;
+    qsizetype cells = static_cast<qsizetype>(rows) * columns;
+    adjacency.offsets.resize(cells + 1);
+    adjacency.neighbours.resize(total);
+    adjacency.offsets[cells] = total;
+
+    //Second pass writes each band straight into its slice, geometry is only evaluated here
+    qsizetype *offsets = adjacency.offsets.data();
+    int *neighbours = adjacency.neighbours.data();
+    forEachBand([this, rows, columns, offsets, neighbours](Band &band) {
+        QVector<int> out;
+        qsizetype next = band.base;
+        for(int i = band.firstRow; i < band.lastRow; ++i) {
+            for(int j = 0; j < columns; ++j) {
+                offsets[static_cast<qsizetype>(i) * columns + j] = next;
+                out.clear();
+                appendNeighbours(i, j, rows, columns, out);
+                std::copy(out.cbegin(), out.cend(), neighbours + next);
+                next += out.size();
+            }
+        }
+    });
+
+    return adjacency;
+}
+
+BoardTopology *BoardTopology::create(const QString &name, int layers)
+{
+    if(name == "Hexagonal") return new HexTopology();
+    if(name == "Torus") return new TorusTopology();
+    if(name == "Cubic") return new CubicTopology(layers);
+    return new SquareTopology();
+}
+
+QStringList BoardTopology::names()
+{
+    return {"Square", "Hexagonal", "Torus", "Cubic"};
+}
+
+QStringList BoardTopology::windowNames()
+{
+    //Only those the square grid view shows as they are, hex offsets and cubic layers are bot only
+    return {"Square", "Torus"};
+}
+
+QString SquareTopology::name() const
+{
+    return "Square";
+}
+
+BoardTopology *SquareTopology::clone() const
+{
+    return new SquareTopology(*this);
+}
+
+void SquareTopology::appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const
+{
+    int offset[3] = {-1, 0, 1};
+    for(int i = 0; i < 3; ++i) {
+        for(int j = 0; j < 3; ++j) {
+            int a = row + offset[i], b = col + offset[j];
+            if((a == row && b == col) || a < 0 || b < 0 || a >= rows || b >= columns) continue;
+            out.push_back(a * columns + b);
+        }
+    }
+}
+
+int SquareTopology::maxNeighbours() const
+{
+    return 8;
+}
+
+QString HexTopology::name() const
+{
+    return "Hexagonal";
+}
+
+BoardTopology *HexTopology::clone() const
+{
+    return new HexTopology(*this);
+}
+
+void HexTopology::appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const
+{
+    //Diagonal neighbours lean right on odd rows and left on even rows
+    int shift = (row & 1) ? 0 : -1;
+    int offset[6][2] = {{0, -1}, {0, 1},
+                        {-1, shift}, {-1, shift + 1},
+                        {1, shift}, {1, shift + 1}};
+    for(int i = 0; i < 6; ++i) {
+        int a = row + offset[i][0], b = col + offset[i][1];
+        if(a < 0 || b < 0 || a >= rows || b >= columns) continue;
+        out.push_back(a * columns + b);
+    }
+}
+
+int HexTopology::maxNeighbours() const
+{
+    return 6;
+}
+
+QString TorusTopology::name() const
+{
+    return "Torus";
+}
+
+BoardTopology *TorusTopology::clone() const
+{
+    return new TorusTopology(*this);
+}
+
+void TorusTopology::appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const
+{
+    int offset[3] = {-1, 0, 1};
+    for(int i = 0; i < 3; ++i) {
+        for(int j = 0; j < 3; ++j) {
+            int a = (row + offset[i] + rows) % rows, b = (col + offset[j] + columns) % columns;
+            int cell = a * columns + b;
+
+            //Narrow boards wrap onto themselves, skip self and repeats
+            if((a == row && b == col) || out.contains(cell)) continue;
+            out.push_back(cell);
+        }
+    }
+}
+
+int TorusTopology::maxNeighbours() const
+{
+    return 8;
+}
+
+CubicTopology::CubicTopology(int layers) : layers(qMax(1, layers))
+{
+}
+
+QString CubicTopology::name() const
+{
+    return "Cubic";
+}
+
+BoardTopology *CubicTopology::clone() const
+{
+    return new CubicTopology(*this);
+}
+
+void CubicTopology::appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const
+{
+    //Each layer is a band of rows, the last band may be shorter
+    int layerHeight = (rows + layers - 1) / layers;
+    int layer = row / layerHeight, layerRow = row % layerHeight;
+    int offset[3] = {-1, 0, 1};
+
+    for(int l = 0; l < 3; ++l) {
+        for(int i = 0; i < 3; ++i) {
+            for(int j = 0; j < 3; ++j) {
+                int c = layer + offset[l], r = layerRow + offset[i], b = col + offset[j];
+                if(c < 0 || c >= layers || r < 0 || r >= layerHeight || b < 0 || b >= columns) continue;
+
+                int a = c * layerHeight + r;
+                if(a >= rows || (a == row && b == col)) continue;
+                out.push_back(a * columns + b);
+            }
+        }
+    }
+}
+
+int CubicTopology::maxNeighbours() const
+{
+    return 26;
+}
+
+int CubicTopology::layerCount() const
+{
+    return layers;
+}
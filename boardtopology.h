@@ -0,0 +1,88 @@
+#ifndef BOARDTOPOLOGY_H
+#define BOARDTOPOLOGY_H
+
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+//Neighbour relation of a board, compiled once per board into a flat adjacency array
+class BoardTopology
+{
+public:
+    //Compressed sparse rows, neighbours of cell i are neighbours[offsets[i]] up to neighbours[offsets[i + 1]]
+    struct Adjacency {
+        QVector<qsizetype> offsets;
+        QVector<int> neighbours;
+
+        const int *begin(int cell) const { return neighbours.constData() + offsets[cell]; }
+        const int *end(int cell) const { return neighbours.constData() + offsets[cell + 1]; }
+    };
+
+    virtual ~BoardTopology();
+    virtual QString name() const = 0;
+    virtual BoardTopology *clone() const = 0;
+    virtual void appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const = 0;
+    virtual int maxNeighbours() const = 0;
+    virtual int layerCount() const;
+    qint64 compiledBytes(int rows, int columns) const;
+    bool canCompile(int rows, int columns) const;
+    Adjacency compile(int rows, int columns) const;
+
+    //Boards with at least this many cells are compiled a band of rows at a time across the thread pool
+    static const int PARALLEL_COMPILE_THRESHOLD = 1 << 20;
+    static const int COMPILE_BAND_ROWS = 256;
+
+    //Largest adjacency compile() will build, a 10000 x 10000 square board just fits
+    static const qint64 MAX_COMPILED_BYTES = qint64(4) << 30;
+
+    static BoardTopology *create(const QString &name, int layers = 3);
+    static QStringList names();
+    static QStringList windowNames();
+};
+
+//Classic 3x3 neighbourhood
+class SquareTopology : public BoardTopology
+{
+public:
+    QString name() const override;
+    BoardTopology *clone() const override;
+    void appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const override;
+    int maxNeighbours() const override;
+};
+
+//Six neighbours with odd rows shifted half a cell right
+class HexTopology : public BoardTopology
+{
+public:
+    QString name() const override;
+    BoardTopology *clone() const override;
+    void appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const override;
+    int maxNeighbours() const override;
+};
+
+//3x3 neighbourhood wrapping around both edges
+class TorusTopology : public BoardTopology
+{
+public:
+    QString name() const override;
+    BoardTopology *clone() const override;
+    void appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const override;
+    int maxNeighbours() const override;
+};
+
+//3x3x3 neighbourhood, the table's rows are split into stacked layers
+class CubicTopology : public BoardTopology
+{
+private:
+    int layers;
+
+public:
+    explicit CubicTopology(int layers = 3);
+    QString name() const override;
+    BoardTopology *clone() const override;
+    void appendNeighbours(int row, int col, int rows, int columns, QVector<int> &out) const override;
+    int maxNeighbours() const override;
+    int layerCount() const override;
+};
+
+#endif // BOARDTOPOLOGY_H
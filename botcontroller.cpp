@@ -0,0 +1,198 @@
+#include "botcontroller.h"
+#include "memoryaccounting.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <cstdio>
+
+
+BotController::BotController(QObject *parent) : QObject(parent),
+    input(stdin), output(stdout), minefield(nullptr), rows(0), columns(0), mineDisplayCount(0),
+    batchCount(0), started(false), finished(false), gameWon(false)
+{
+}
+
+int BotController::run()
+{
+    //Each line is one batch, replies are written in the same order so bots can pipeline
+    QString line;
+    while(input.readLineInto(&line)) {
+        if(line.trimmed().isEmpty()) continue;
+        ++batchCount;
+
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(line.toUtf8(), &parseError);
+        if(parseError.error != QJsonParseError::NoError || !document.isObject()) {
+            writeReply({{"batch", batchCount}, {"error", "Batch must be a JSON object"}});
+            continue;
+        }
+        QJsonObject batch = document.object();
+
+        //Memory report on demand, written to stderr so replies stay one line each
+        if(batch.value("memstats").toBool()) MemoryAccounting::dump();
+
+        //Optional new game comes before any moves in the same batch
+        if(batch.contains("new")) {
+            QString error = newGame(batch.value("new").toObject());
+            if(!error.isEmpty()) {
+                writeReply({{"batch", batchCount}, {"error", error}});
+                continue;
+            }
+        }
+        if(minefield == nullptr) {
+            writeReply({{"batch", batchCount}, {"error", "No game, send a \"new\" batch first"}});
+            continue;
+        }
+
+        //Apply every move and stop at the first malformed one
+        QString error;
+        const QJsonArray moves = batch.value("moves").toArray();
+        for(const QJsonValue &move : moves) {
+            error = applyMove(move.toArray());
+            if(!error.isEmpty()) break;
+        }
+
+        QJsonObject reply = buildDelta();
+        if(!error.isEmpty()) reply.insert("error", error);
+        writeReply(reply);
+    }
+
+    return 0;
+}
+
+QString BotController::newGame(const QJsonObject &options)
+{
+    //Check the size before touching the current game so a bad batch leaves it playable
+    int newRows = qMax(1, options.value("rows").toInt(10));
+    int newColumns = qMax(1, options.value("cols").toInt(16));
+    if(newRows > MAX_BOARD_SIDE || newColumns > MAX_BOARD_SIDE) {
+        return QString("Board sides are limited to %0 cells").arg(MAX_BOARD_SIDE);
+    }
+
+    //Neighbour tables grow with the neighbourhood, a cubic board tops out well before the side limit
+    BoardTopology *topology = BoardTopology::create(options.value("topology").toString("Square"), options.value("layers").toInt(3));
+    if(!topology->canCompile(newRows, newColumns)) {
+        QString error = QString("%0 board of %1 x %2 needs too much memory").arg(topology->name()).arg(newRows).arg(newColumns);
+        delete topology;
+        return error;
+    }
+
+    //Delete old game
+    if(minefield != nullptr) delete minefield;
+
+    rows = newRows;
+    columns = newColumns;
+    int mineCount = qBound(0, options.value("mines").toInt(20), rows * columns - 1);
+
+    minefield = new MinefieldModel(rows, columns, mineCount, this);
+    minefield->setTopology(topology);
+    minefield->setForgiving(options.value("forgiving").toBool(false));
+    minefield->setBoardValueRange(options.value("minBBBV").toInt(0), options.value("maxBBBV").toInt(0));
+    if(options.contains("seed")) minefield->setSeed(static_cast<quint32>(options.value("seed").toDouble()));
+    mineDisplayCount = mineCount;
+    started = false;
+    finished = false;
+    gameWon = false;
+    changedCells.clear();
+    changedLookup.clear();
+
+    //Listen to the same notifications the view would get
+    connect(minefield, &MinefieldModel::dataChanged, this, &BotController::recordChange);
+    connect(minefield, &MinefieldModel::mineDisplayUpdated, this, &BotController::recordMineDisplay);
+    connect(minefield, &MinefieldModel::gameOver, this, &BotController::recordGameOver);
+    return QString();
+}
+
+QString BotController::applyMove(const QJsonArray &move)
+{
+    //Moves are compact arrays of the form ["open" | "flag" | "chord", row, col]
+    if(move.size() != 3) return "Move must be [op, row, col]";
+    QString op = move.at(0).toString();
+    int row = move.at(1).toInt(-1), col = move.at(2).toInt(-1);
+    if(row < 0 || col < 0 || row >= rows || col >= columns) return "Move out of bounds";
+    if(op != "open" && op != "flag" && op != "chord") return "Unknown move \"" + op + "\"";
+
+    //Board is disabled once the game is over, same as the view
+    if(finished) return QString();
+
+    //First input of any kind starts the game, same as Gameboard
+    if(!started) {
+        started = true;
+        minefield->populateMines(row, col);
+    }
+
+    QModelIndex index = minefield->index(row, col);
+    if(op == "flag") {
+        minefield->setData(index, QVariant(), MinefieldModel::FlagStatusRole);
+    } else if(op == "open") {
+        minefield->setData(index, QVariant(), MinefieldModel::OpenStatusRole);
+    } else if(index.data(MinefieldModel::OpenStatusRole).toBool()) {//Chording is opening an already open cell
+        minefield->setData(index, QVariant(), MinefieldModel::OpenStatusRole);
+    }
+
+    return QString();
+}
+
+QJsonObject BotController::buildDelta() const
+{
+    //Only report cells changed by this batch, never the whole board
+    QJsonArray revealed, flags;
+    for(int cell : changedCells) {
+        int row = cell / columns, col = cell % columns;
+        QModelIndex index = minefield->index(row, col);
+
+        if(index.data(MinefieldModel::OpenStatusRole).toBool()) {
+            int count = index.data(MinefieldModel::MineStatusRole).toBool() ? -1 : index.data(MinefieldModel::MineCountRole).toInt();
+            revealed.append(QJsonArray({row, col, count}));
+        } else {
+            flags.append(QJsonArray({row, col, index.data(MinefieldModel::FlagStatusRole).toBool() ? 1 : 0}));
+        }
+    }
+
+    QString state = !finished ? "playing" : (gameWon ? "won" : "lost");
+    QJsonObject delta({{"batch", batchCount},
+                       {"revealed", revealed},
+                       {"flags", flags},
+                       {"mines", mineDisplayCount},
+                       {"bbbv", minefield->getBoardValue()},
+                       {"seed", static_cast<qint64>(minefield->getSeed())},
+                       {"hash", QString::number(minefield->getBoardHash(), 16)},
+                       {"state", state}});
+
+    //Lost on a guess forgiving mode ran out of time to check
+    if(finished && !gameWon && minefield->isLossUnproven()) delta.insert("unproven", true);
+    return delta;
+}
+
+void BotController::writeReply(const QJsonObject &reply)
+{
+    output << QJsonDocument(reply).toJson(QJsonDocument::Compact) << '\n';
+    output.flush();
+
+    //Start next batch fresh
+    changedCells.clear();
+    changedLookup.clear();
+}
+
+void BotController::recordChange(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for(int i = topLeft.row(); i <= bottomRight.row(); ++i) {
+        for(int j = topLeft.column(); j <= bottomRight.column(); ++j) {
+            int cell = i * columns + j;
+            if(!changedLookup.contains(cell)) {
+                changedLookup.insert(cell);
+                changedCells.push_back(cell);
+            }
+        }
+    }
+}
+
+void BotController::recordMineDisplay(int mineDisplayCount)
+{
+    this->mineDisplayCount = mineDisplayCount;
+}
+
+void BotController::recordGameOver(bool gameWon)
+{
+    finished = true;
+    this->gameWon = gameWon;
+}
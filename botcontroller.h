@@ -0,0 +1,52 @@
+#ifndef BOTCONTROLLER_H
+#define BOTCONTROLLER_H
+
+#include <QObject>
+#include <QTextStream>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QVector>
+#include <QSet>
+#include "minefieldmodel.h"
+
+//Headless driver that reads batches of moves as JSON lines on stdin and
+//answers each batch with a single JSON line delta on stdout
+class BotController : public QObject
+{
+    Q_OBJECT
+private:
+    QTextStream input,
+                output;
+    MinefieldModel *minefield;
+    int rows,
+        columns,
+        mineDisplayCount,
+        batchCount;
+    bool started,
+         finished,
+         gameWon;
+
+    //Cells touched by the current batch, in the order they changed
+    QVector<int> changedCells;
+    QSet<int> changedLookup;
+
+    //Largest side accepted from a bot, keeps rows * columns well inside an int. A square board
+    //this size peaks at about 5.2 GB: 0.8 GB of cells, 4 GB of neighbour table, 0.4 GB for 3BV
+    static const int MAX_BOARD_SIDE = 10000;
+
+    QString newGame(const QJsonObject &options);
+    QString applyMove(const QJsonArray &move);
+    QJsonObject buildDelta() const;
+    void writeReply(const QJsonObject &reply);
+
+public:
+    explicit BotController(QObject *parent = nullptr);
+    int run();
+
+private slots:
+    void recordChange(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void recordMineDisplay(int mineDisplayCount);
+    void recordGameOver(bool gameWon);
+};
+
+#endif // BOTCONTROLLER_H
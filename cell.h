@@ -6,7 +6,8 @@ class Cell
 public:
     enum CellStatus { Flagged = (1 << 0),
                       Opened = (1 << 1),
-                      HasMine = (1 << 2) };
+                      HasMine = (1 << 2),
+                      Pending = (1 << 3) };//Opened but not yet shown by the view
 private:
     int minesAdjacent,
         status;
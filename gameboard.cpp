@@ -1,10 +1,12 @@
 #include "gameboard.h"
 #include "minefieldmodel.h"
+#include "memoryaccounting.h"
 #include <QMouseEvent>
 #include <QHeaderView>
+#include <QResizeEvent>
 
 
-Gameboard::Gameboard(QWidget *parent) : QTableView(parent), disabled(false), started(false)
+Gameboard::Gameboard(QWidget *parent) : QTableView(parent), disabled(false), started(false), viewportBytes(0)
 {
     //Set board styling
     this->setFont(QFont("Segoe UI", 14, 900));
@@ -17,6 +19,11 @@ Gameboard::Gameboard(QWidget *parent) : QTableView(parent), disabled(false), sta
     this->setShowGrid(false);
 }
 
+Gameboard::~Gameboard()
+{
+    MemoryAccounting::released(MemoryAccounting::Gameboard, viewportBytes);
+}
+
 void Gameboard::mousePressEvent(QMouseEvent *event)
 {
     //Do not handle any events if game not playable
@@ -57,6 +64,17 @@ void Gameboard::mouseDoubleClickEvent(QMouseEvent *event)
     Gameboard::mousePressEvent(event);
 }
 
+void Gameboard::resizeEvent(QResizeEvent *event)
+{
+    //Approximate the backing store the view paints into
+    MemoryAccounting::released(MemoryAccounting::Gameboard, viewportBytes);
+    qreal ratio = this->devicePixelRatioF();
+    viewportBytes = static_cast<qint64>(event->size().width() * ratio) * static_cast<qint64>(event->size().height() * ratio) * 4;
+    MemoryAccounting::allocated(MemoryAccounting::Gameboard, viewportBytes);
+
+    QTableView::resizeEvent(event);
+}
+
 void Gameboard::disableView()
 {
     disabled = true;
@@ -8,15 +8,18 @@ class Gameboard : public QTableView
     Q_OBJECT
 public:
     explicit Gameboard(QWidget *parent = nullptr);
+    ~Gameboard();
     void disableView();
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
 private:
     bool disabled;
     bool started;
+    qint64 viewportBytes;
 
 signals:
     void gameStarted(int row, int col);
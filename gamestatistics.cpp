@@ -0,0 +1,316 @@
+#include "gamestatistics.h"
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+#include <algorithm>
+
+
+const char *GameStatistics::columnNames[GameStatistics::ColumnCount] = {
+    "size.col", "mines.col", "seed.col", "duration.col", "clicks.col", "bbbv.col", "result.col", "firstclick.col", "topology.col", "mode.col"
+};
+
+const int GameStatistics::columnWidths[GameStatistics::ColumnCount] = {
+    sizeof(quint32), sizeof(quint32), sizeof(quint32), sizeof(quint32), sizeof(quint32), sizeof(quint32), sizeof(quint8),
+    sizeof(quint32), sizeof(quint32), sizeof(quint8)
+};
+
+GameStatistics::GameStatistics(const QString &directory) : rowCount(0), available(true)
+{
+    //Default to the per user data directory
+    path = directory;
+    if(path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/statistics-v2";
+    }
+    QDir().mkpath(path + "/wins");
+
+    //Every column has to open, a store missing one stays disabled instead of being trimmed to match it
+    qint64 shortest = -1, longest = 0;
+    for(int i = 0; i < ColumnCount; ++i) {
+        files[i].setFileName(path + "/" + columnNames[i]);
+        if(!files[i].open(QIODevice::ReadWrite)) {
+            disable();
+            return;
+        }
+        qint64 size = files[i].size();
+        shortest = (shortest < 0) ? size / columnWidths[i] : qMin(shortest, size / columnWidths[i]);
+        longest = qMax(longest, (size + columnWidths[i] - 1) / columnWidths[i]);
+    }
+
+    //An interrupted append leaves at most one partly written row, anything more is left alone
+    if(longest - shortest > 1) {
+        disable();
+        return;
+    }
+    rowCount = shortest;
+
+    //Drop the partly written row so columns stay aligned
+    for(int i = 0; i < ColumnCount; ++i) {
+        if(files[i].size() != rowCount * columnWidths[i] && !files[i].resize(rowCount * columnWidths[i])) {
+            disable();
+            return;
+        }
+    }
+
+    //Saved counts only stand if they cover exactly the rows on disk, otherwise
+    //an interrupted append is recovered with one scan of the columns
+    if(!readAggregates()) rebuildAggregates();
+}
+
+bool GameStatistics::isAvailable() const
+{
+    return available;
+}
+
+bool GameStatistics::append(const Record &record)
+{
+    if(!available) return false;
+
+    quint32 values[ColumnCount] = { packSize(record.rows, record.columns),
+                                    static_cast<quint32>(record.mines),
+                                    record.seed,
+                                    record.durationMs,
+                                    record.clicks,
+                                    record.boardValue,
+                                    record.won ? 1u : 0u,
+                                    packSize(record.firstClickRow, record.firstClickColumn),
+                                    packTopology(record.topology, record.layers),
+                                    record.forgiving ? 1u : 0u };
+
+    bool written = true;
+    for(int i = 0; i < ColumnCount; ++i) {
+        files[i].seek(rowCount * columnWidths[i]);
+        if(columnWidths[i] == sizeof(quint8)) {
+            quint8 value = static_cast<quint8>(values[i]);
+            written &= files[i].write(reinterpret_cast<const char *>(&value), sizeof(value)) == sizeof(value);
+        } else {
+            written &= files[i].write(reinterpret_cast<const char *>(&values[i]), sizeof(quint32)) == sizeof(quint32);
+        }
+        files[i].flush();
+    }
+
+    //A failed row is overwritten by the next append or trimmed on the next open
+    if(!written) return false;
+    ++rowCount;
+
+    //Should either write fail the saved row count no longer matches and the next open rebuilds
+    Difficulty difficulty = difficultyOf(record);
+    Aggregate &aggregate = aggregates[difficulty];
+    ++aggregate.games;
+    if(record.won) {
+        ++aggregate.wins;
+        insertWinTime(difficulty, record.durationMs);
+    }
+    writeAggregates();
+    return true;
+}
+
+qint64 GameStatistics::count() const
+{
+    return rowCount;
+}
+
+GameStatistics::Summary GameStatistics::summarize(const Record &game) const
+{
+    Summary summary;
+    auto found = aggregates.constFind(difficultyOf(game));
+    if(found == aggregates.constEnd()) return summary;
+
+    summary.games = found->games;
+    summary.wins = found->wins;
+    summary.winRate = static_cast<double>(summary.wins) / summary.games;
+    if(summary.wins > 0) {
+        summary.bestTime = winTimeAt(found.key(), 0) / 1000.0;
+        summary.medianTime = winTimeAt(found.key(), 0.5) / 1000.0;
+        summary.p90Time = winTimeAt(found.key(), 0.9) / 1000.0;
+    }
+    return summary;
+}
+
+double GameStatistics::percentileTime(const Record &game, double percentile) const
+{
+    if(!available) return 0;
+    return winTimeAt(difficultyOf(game), percentile) / 1000.0;
+}
+
+bool GameStatistics::readAggregates()
+{
+    QFile file(path + "/aggregates.dat");
+    if(!file.open(QIODevice::ReadOnly)) return false;
+
+    //Header is the row count the file covers and the number of difficulties
+    qint64 coveredRows = 0;
+    quint32 entries = 0;
+    if(file.read(reinterpret_cast<char *>(&coveredRows), sizeof(coveredRows)) != sizeof(coveredRows) ||
+       file.read(reinterpret_cast<char *>(&entries), sizeof(entries)) != sizeof(entries) ||
+       coveredRows != rowCount) {
+        return false;
+    }
+
+    for(quint32 i = 0; i < entries; ++i) {
+        Difficulty difficulty;
+        Aggregate aggregate;
+        if(file.read(reinterpret_cast<char *>(&difficulty.size), sizeof(quint32)) != sizeof(quint32) ||
+           file.read(reinterpret_cast<char *>(&difficulty.mines), sizeof(quint32)) != sizeof(quint32) ||
+           file.read(reinterpret_cast<char *>(&difficulty.topology), sizeof(quint32)) != sizeof(quint32) ||
+           file.read(reinterpret_cast<char *>(&difficulty.mode), sizeof(quint8)) != sizeof(quint8) ||
+           file.read(reinterpret_cast<char *>(&aggregate.games), sizeof(qint64)) != sizeof(qint64) ||
+           file.read(reinterpret_cast<char *>(&aggregate.wins), sizeof(qint64)) != sizeof(qint64) ||
+           QFile(indexPath(difficulty)).size() != aggregate.wins * static_cast<qint64>(sizeof(quint32))) {
+            aggregates.clear();
+            return false;
+        }
+        aggregates.insert(difficulty, aggregate);
+    }
+    return true;
+}
+
+bool GameStatistics::writeAggregates() const
+{
+    //Written whole and swapped in, a crash leaves the previous file which then no longer matches the row count
+    QSaveFile file(path + "/aggregates.dat");
+    if(!file.open(QIODevice::WriteOnly)) return false;
+
+    quint32 entries = static_cast<quint32>(aggregates.size());
+    file.write(reinterpret_cast<const char *>(&rowCount), sizeof(rowCount));
+    file.write(reinterpret_cast<const char *>(&entries), sizeof(entries));
+    for(auto it = aggregates.constBegin(); it != aggregates.constEnd(); ++it) {
+        file.write(reinterpret_cast<const char *>(&it.key().size), sizeof(quint32));
+        file.write(reinterpret_cast<const char *>(&it.key().mines), sizeof(quint32));
+        file.write(reinterpret_cast<const char *>(&it.key().topology), sizeof(quint32));
+        file.write(reinterpret_cast<const char *>(&it.key().mode), sizeof(quint8));
+        file.write(reinterpret_cast<const char *>(&it.value().games), sizeof(qint64));
+        file.write(reinterpret_cast<const char *>(&it.value().wins), sizeof(qint64));
+    }
+    return file.commit();
+}
+
+void GameStatistics::rebuildAggregates()
+{
+    aggregates.clear();
+    QDir(path + "/wins").removeRecursively();
+    QDir().mkpath(path + "/wins");
+
+    //Only runs on first use or after an interrupted append, so the winning
+    //times are held just long enough to be sorted into their index files
+    if(rowCount > 0) {
+        const Column needed[] = {SizeColumn, MinesColumn, DurationColumn, ResultColumn, TopologyColumn, ModeColumn};
+        uchar *maps[ColumnCount] = {};
+        bool mapped = true;
+        for(Column column : needed) {
+            maps[column] = files[column].map(0, rowCount * columnWidths[column]);
+            mapped &= maps[column] != nullptr;
+        }
+
+        QHash<Difficulty, QVector<quint32>> winTimes;
+        if(mapped) {
+            const quint32 *sizes = reinterpret_cast<const quint32 *>(maps[SizeColumn]);
+            const quint32 *mineCounts = reinterpret_cast<const quint32 *>(maps[MinesColumn]);
+            const quint32 *durations = reinterpret_cast<const quint32 *>(maps[DurationColumn]);
+            const quint8 *results = reinterpret_cast<const quint8 *>(maps[ResultColumn]);
+            const quint32 *topologies = reinterpret_cast<const quint32 *>(maps[TopologyColumn]);
+            const quint8 *modes = reinterpret_cast<const quint8 *>(maps[ModeColumn]);
+            for(qint64 i = 0; i < rowCount; ++i) {
+                Difficulty difficulty{sizes[i], mineCounts[i], topologies[i], modes[i]};
+                Aggregate &aggregate = aggregates[difficulty];
+                ++aggregate.games;
+                if(results[i]) {
+                    ++aggregate.wins;
+                    winTimes[difficulty].push_back(durations[i]);
+                }
+            }
+        }
+
+        for(Column column : needed) {
+            if(maps[column] != nullptr) files[column].unmap(maps[column]);
+        }
+
+        //History that cannot be read is not appended to either
+        if(!mapped) {
+            disable();
+            return;
+        }
+
+        for(auto it = winTimes.begin(); it != winTimes.end(); ++it) {
+            std::sort(it->begin(), it->end());
+            QFile index(indexPath(it.key()));
+            if(!index.open(QIODevice::WriteOnly) ||
+               index.write(reinterpret_cast<const char *>(it->constData()), it->size() * sizeof(quint32)) != it->size() * static_cast<qint64>(sizeof(quint32))) {
+                disable();
+                return;
+            }
+        }
+    }
+
+    writeAggregates();
+}
+
+bool GameStatistics::insertWinTime(const Difficulty &difficulty, quint32 durationMs) const
+{
+    QFile index(indexPath(difficulty));
+    if(!index.open(QIODevice::ReadWrite)) return false;
+
+    //Grow by one slot and shift the slower times up inside the mapping
+    qint64 count = index.size() / sizeof(quint32);
+    if(!index.resize((count + 1) * sizeof(quint32))) return false;
+    uchar *map = index.map(0, (count + 1) * sizeof(quint32));
+    if(map == nullptr) return false;
+
+    quint32 *times = reinterpret_cast<quint32 *>(map);
+    quint32 *slot = std::upper_bound(times, times + count, durationMs);
+    std::move_backward(slot, times + count, times + count + 1);
+    *slot = durationMs;
+    index.unmap(map);
+    return true;
+}
+
+quint32 GameStatistics::winTimeAt(const Difficulty &difficulty, double percentile) const
+{
+    //The index is mapped only for the lookup, nothing is kept in memory
+    QFile index(indexPath(difficulty));
+    qint64 count = index.size() / sizeof(quint32);
+    if(count == 0 || !index.open(QIODevice::ReadOnly)) return 0;
+
+    qint64 rank = qBound(qint64(0), static_cast<qint64>(percentile * (count - 1) + 0.5), count - 1);
+    uchar *map = index.map(rank * sizeof(quint32), sizeof(quint32));
+    if(map == nullptr) return 0;
+    quint32 time = *reinterpret_cast<const quint32 *>(map);
+    index.unmap(map);
+    return time;
+}
+
+QString GameStatistics::indexPath(const Difficulty &difficulty) const
+{
+    return QString("%1/wins/%2-%3-%4-%5.idx").arg(path)
+                                              .arg(difficulty.size, 8, 16, QChar('0'))
+                                              .arg(difficulty.mines)
+                                              .arg(difficulty.topology, 0, 16)
+                                              .arg(static_cast<uint>(difficulty.mode));
+}
+
+void GameStatistics::disable()
+{
+    //Files are closed untouched, nothing is truncated
+    for(int i = 0; i < ColumnCount; ++i) {
+        files[i].close();
+    }
+    aggregates.clear();
+    rowCount = 0;
+    available = false;
+}
+
+GameStatistics::Difficulty GameStatistics::difficultyOf(const Record &record)
+{
+    return {packSize(record.rows, record.columns), static_cast<quint32>(record.mines),
+            packTopology(record.topology, record.layers), static_cast<quint8>(record.forgiving ? 1 : 0)};
+}
+
+quint32 GameStatistics::packSize(int rows, int columns)
+{
+    return (static_cast<quint32>(rows) << 16) | static_cast<quint32>(columns & 0xFFFF);
+}
+
+quint32 GameStatistics::packTopology(int topology, int layers)
+{
+    return (static_cast<quint32>(layers) << 8) | static_cast<quint32>(topology & 0xFF);
+}
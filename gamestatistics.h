@@ -0,0 +1,103 @@
+#ifndef GAMESTATISTICS_H
+#define GAMESTATISTICS_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+
+//Append-only store of finished games, one memory mapped file per column so
+//aggregate queries only touch the columns they need
+class GameStatistics
+{
+public:
+    //Seed, first click and topology are enough to generate the same board again
+    struct Record {
+        int rows = 0,
+            columns = 0,
+            mines = 0,
+            firstClickRow = 0,
+            firstClickColumn = 0,
+            topology = 0,//Index into BoardTopology::names()
+            layers = 1;
+        quint32 seed = 0,
+                durationMs = 0,
+                clicks = 0,
+                boardValue = 0;
+        bool won = false,
+             forgiving = false;
+    };
+
+    struct Summary {
+        qint64 games = 0,
+               wins = 0;
+        double winRate = 0,
+               bestTime = 0,
+               medianTime = 0,
+               p90Time = 0;
+    };
+
+    explicit GameStatistics(const QString &directory = QString());
+    bool isAvailable() const;
+    bool append(const Record &record);
+    qint64 count() const;
+    Summary summarize(const Record &game) const;
+    double percentileTime(const Record &game, double percentile) const;
+
+private:
+    enum Column { SizeColumn,
+                  MinesColumn,
+                  SeedColumn,
+                  DurationColumn,
+                  ClicksColumn,
+                  BoardValueColumn,
+                  ResultColumn,
+                  FirstClickColumn,
+                  TopologyColumn,
+                  ModeColumn,
+                  ColumnCount };
+    static const char *columnNames[ColumnCount];
+    static const int columnWidths[ColumnCount];
+
+    //Games are grouped by everything that makes two boards comparable, forgiving games never mix with normal ones
+    struct Difficulty {
+        quint32 size,
+                mines,
+                topology;
+        quint8 mode;
+        bool operator==(const Difficulty &other) const
+        {
+            return size == other.size && mines == other.mines && topology == other.topology && mode == other.mode;
+        }
+        friend size_t qHash(const Difficulty &difficulty, size_t seed = 0)
+        {
+            return qHashMulti(seed, difficulty.size, difficulty.mines, difficulty.topology, difficulty.mode);
+        }
+    };
+
+    //Counts are saved next to the columns and kept current by append(), the
+    //winning times live in one sorted index file per difficulty
+    struct Aggregate {
+        qint64 games = 0,
+               wins = 0;
+    };
+    QHash<Difficulty, Aggregate> aggregates;
+
+    QString path;
+    QFile files[ColumnCount];
+    qint64 rowCount;
+    bool available;
+
+    bool readAggregates();
+    bool writeAggregates() const;
+    void rebuildAggregates();
+    bool insertWinTime(const Difficulty &difficulty, quint32 durationMs) const;
+    quint32 winTimeAt(const Difficulty &difficulty, double percentile) const;
+    QString indexPath(const Difficulty &difficulty) const;
+    void disable();
+    static Difficulty difficultyOf(const Record &record);
+    static quint32 packSize(int rows, int columns);
+    static quint32 packTopology(int topology, int layers);
+};
+
+#endif // GAMESTATISTICS_H
@@ -1,11 +1,36 @@
 #include "mainwindow.h"
+#include "botcontroller.h"
+#include "memoryaccounting.h"
 #include <QApplication>
+#include <QCoreApplication>
 
 
 int main(int argc, char *argv[])
 {
+    //Memory accounting is opt-in and reported again at exit
+    bool botMode = false;
+    for(int i = 1; i < argc; ++i) {
+        if(QString(argv[i]) == "--memstats") MemoryAccounting::setEnabled(true);
+        if(QString(argv[i]) == "--bot") botMode = true;
+    }
+    if(!qEnvironmentVariableIsEmpty("MINESWEEPER_MEMSTATS")) MemoryAccounting::setEnabled(true);
+
+    //Headless bot mode drives the model over stdin/stdout without any window
+    if(botMode) {
+        QCoreApplication a(argc, argv);
+        BotController bot;
+        int result = bot.run();
+        MemoryAccounting::dump();
+        return result;
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
-    w.show();
-    return a.exec();
+    int result;
+    {
+        MainWindow w;
+        w.show();
+        result = a.exec();
+    }
+    MemoryAccounting::dump();
+    return result;
 }
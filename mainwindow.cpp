@@ -1,13 +1,15 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "settingsdialog.h"
+#include "memoryaccounting.h"
+#include "reviewdialog.h"
 #include <QHeaderView>
 #include <QSettings>
 #include <QMessageBox>
 
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow),
-    clockUpdateTimer(new QTimer(this)), minefield(nullptr), delegate(nullptr), gameboard(nullptr)
+MainWindow::MainWindow(QWidget *parent, const QString &statisticsDirectory) : QMainWindow(parent), ui(new Ui::MainWindow),
+    clockUpdateTimer(new QTimer(this)), statistics(statisticsDirectory), minefield(nullptr), delegate(nullptr), gameboard(nullptr)
 {
     //Setup UI from form
     ui->setupUi(this);
@@ -16,10 +18,14 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(ui->actionNew_Game, &QAction::triggered, this, &MainWindow::resetGame);
     connect(ui->actionQuit, &QAction::triggered, this, &QApplication::exit);
     connect(ui->actionHelp, &QAction::triggered, this, &MainWindow::helpMessage);
+    connect(ui->actionReview, &QAction::triggered, this, &MainWindow::reviewGames);
+    connect(ui->actionMemoryReport, &QAction::triggered, this, &MainWindow::memoryReport);
+    ui->actionMemoryReport->setVisible(MemoryAccounting::isEnabled());
     connect(ui->actionSettings, &QAction::triggered, []() {
         SettingsDialog dialog;
         dialog.exec();
     });
+    connect(ui->actionForgiving, &QAction::toggled, this, &MainWindow::setForgivingMode);
     connect(ui->newGameButton, &QPushButton::clicked, this, &MainWindow::resetGame);
 
     //Setup game
@@ -28,6 +34,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 
 MainWindow::~MainWindow()
 {
+    for(const ArchivedBoard &game : finishedGames) {
+        MemoryAccounting::released(MemoryAccounting::Archive, game.byteSize());
+    }
     delete ui;
 }
 
@@ -40,6 +49,14 @@ void MainWindow::loadGameSettings()
     gameRows = settings.value("gameRows", 10).toInt();
     gameCols = settings.value("gameCols", 16).toInt();
     mineCount = settings.value("mineCount", 20).toInt();
+    minBoardValue = settings.value("minBoardValue", 0).toInt();
+    maxBoardValue = settings.value("maxBoardValue", 0).toInt();
+    revealBudget = settings.value("revealBudget", 8).toInt();
+    animateReveal = settings.value("animateReveal", false).toBool();
+    topologyName = settings.value("topology", "Square").toString();
+    if(!BoardTopology::windowNames().contains(topologyName)) topologyName = "Square";
+    forgiving = settings.value("forgiving", false).toBool();
+    ui->actionForgiving->setChecked(forgiving);
     ui->difficultyComboBox->setCurrentText(settings.value("difficulty", "Intermediate").toString());
     settings.endGroup();
 }
@@ -47,6 +64,10 @@ void MainWindow::loadGameSettings()
 void MainWindow::initMinefield()
 {
     minefield = new MinefieldModel(gameRows, gameCols, mineCount , this);
+    minefield->setBoardValueRange(minBoardValue, maxBoardValue);
+    minefield->setRevealBudget(revealBudget, animateReveal);
+    minefield->setTopology(BoardTopology::create(topologyName));
+    minefield->setForgiving(forgiving);
 }
 
 void MainWindow::initGameboard()
@@ -127,17 +148,70 @@ void MainWindow::stopGame(bool gameWon)
     clockUpdateTimer->stop();
 
     //Prepare output message
-    double score = (gameTimer.isValid() ? gameTimer.elapsed() / 1000.0 : 0);
+    qint64 elapsed = (gameTimer.isValid() ? gameTimer.elapsed() : 0);
+    double score = elapsed / 1000.0;
     QString output;
 
+    //Record game then summarise this difficulty
+    GameStatistics::Record record;
+    record.rows = gameRows;
+    record.columns = gameCols;
+    record.mines = mineCount;
+    record.seed = minefield->getSeed();
+    record.firstClickRow = qMax(0, minefield->getFirstClick()) / gameCols;
+    record.firstClickColumn = qMax(0, minefield->getFirstClick()) % gameCols;
+    record.topology = qMax(0, BoardTopology::names().indexOf(minefield->getTopology()->name()));
+    record.layers = minefield->getTopology()->layerCount();
+    record.durationMs = static_cast<quint32>(elapsed);
+    record.clicks = static_cast<quint32>(minefield->getClickCount());
+    record.boardValue = static_cast<quint32>(minefield->getBoardValue());
+    record.won = gameWon;
+    record.forgiving = forgiving;
+    statistics.append(record);
+    GameStatistics::Summary summary = statistics.summarize(record);
+
+    //Keep a compressed copy of the board for review, a replay of a board already kept replaces it, oldest dropped first
+    ArchivedBoard finished = minefield->archive(gameWon);
+    for(int i = 0; i < finishedGames.size(); ++i) {
+        const ArchivedBoard &kept = finishedGames[i];
+        if(kept.getBoardHash() == finished.getBoardHash() && kept.rowCount() == finished.rowCount() && kept.columnCount() == finished.columnCount()) {
+            MemoryAccounting::released(MemoryAccounting::Archive, finishedGames[i].byteSize());
+            finishedGames.removeAt(i);
+            break;
+        }
+    }
+    finishedGames.push_back(finished);
+    MemoryAccounting::allocated(MemoryAccounting::Archive, finished.byteSize());
+    if(finishedGames.size() > MAX_FINISHED_GAMES) {
+        MemoryAccounting::released(MemoryAccounting::Archive, finishedGames.first().byteSize());
+        finishedGames.removeFirst();
+    }
+
     if(gameWon) {
         output = QString("You Won In %0 Seconds").arg(score);
         ui->newGameButton->setIcon(QIcon(":/images/face_heidi.png"));
     } else {
         output = QString("You Lost In %0 Seconds").arg(score);
+        if(minefield->isLossUnproven()) output += "\nThis guess was too tangled to check in time, so it was not forgiven";
         ui->newGameButton->setIcon(QIcon(":/images/face_dead.png"));
     }
 
+    //3BV per second and share of clicks that were needed
+    int boardValue = minefield->getBoardValue(), clicks = qMax(1, minefield->getClickCount());
+    if(gameWon) {
+        output += QString("\n\n3BV: %0\n3BV/s: %1\nEfficiency: %2%").arg(boardValue)
+                .arg(score > 0 ? boardValue / score : 0, 0, 'f', 2).arg(100.0 * boardValue / clicks, 0, 'f', 0);
+    }
+
+    //Statistics are left out when the store could not be opened
+    if(statistics.isAvailable()) {
+        output += QString("\n\nGames Played: %0\nWin Rate: %1%").arg(summary.games).arg(summary.winRate * 100, 0, 'f', 1);
+    }
+    if(summary.wins > 0) {
+        output += QString("\nBest Time: %0 Seconds\nMedian Time: %1 Seconds\n90th Percentile: %2 Seconds")
+                .arg(summary.bestTime).arg(summary.medianTime).arg(summary.p90Time);
+    }
+
     //Show user game won / game loss message
     QMessageBox::information(this, "Game Over", output);
 }
@@ -175,16 +249,39 @@ void MainWindow::helpMessage()
                 "Left click to open cells\n"\
                 "Right click to flag potential mines\n"\
                 "Create a custom game in the settings or choose your own difficulty\n"\
+                "Forgiving mode moves a mine away from a guess when the numbers allow it\n"\
                 "Settings changes will only be applied on new game");
     QMessageBox::information(this, "About Minesweeper", msg);
 }
 
+void MainWindow::reviewGames()
+{
+    ReviewDialog dialog(finishedGames, this);
+    dialog.exec();
+}
+
+void MainWindow::memoryReport()
+{
+    //Also goes to stderr so it can be captured
+    MemoryAccounting::dump();
+    QMessageBox::information(this, "Memory Report", MemoryAccounting::report());
+}
+
 void MainWindow::updateClockDisplay()
 {
     int elapsedTime = gameTimer.elapsed() / 1000;
     ui->timeLCDNumber->display(elapsedTime);
 }
 
+void MainWindow::setForgivingMode(bool enabled)
+{
+    //Saved like other settings, takes effect on new game
+    QSettings settings("Sebastian Games", "Minesweeper", this);
+    settings.beginGroup("userSettings");
+    settings.setValue("forgiving", enabled);
+    settings.endGroup();
+}
+
 void MainWindow::updateMineCountDisplay(int mineCountDisplay)
 {
     ui->minesLCDNumber->display(mineCountDisplay);
@@ -207,25 +304,35 @@ void MainWindow::on_difficultyComboBox_activated(int index)
     QSettings settings("Sebastian Games", "Minesweeper", this);
     settings.beginGroup("userSettings");
 
-    //Apply new settings based on difficulty
+    //Apply new settings based on difficulty, 3BV ranges keep the middle 80% of boards
     settings.setValue("difficulty", difficulty);
     if(difficulty == "Beginner") {
         settings.setValue("gameRows", 8);
         settings.setValue("gameCols", 10);
         settings.setValue("mineCount", 7);
+        settings.setValue("minBoardValue", 5);
+        settings.setValue("maxBoardValue", 14);
     } else if(difficulty == "Easy") {
         settings.setValue("gameRows", 10);
         settings.setValue("gameCols", 13);
         settings.setValue("mineCount", 16);
+        settings.setValue("minBoardValue", 16);
+        settings.setValue("maxBoardValue", 33);
     } else if(difficulty == "Intermediate") {
         settings.setValue("gameRows", 15);
         settings.setValue("gameCols", 20);
         settings.setValue("mineCount", 40);
+        settings.setValue("minBoardValue", 46);
+        settings.setValue("maxBoardValue", 73);
     } else if(difficulty == "Expert") {
         settings.setValue("gameRows", 19);
         settings.setValue("gameCols", 26);
         settings.setValue("mineCount", 99);
+        settings.setValue("minBoardValue", 148);
+        settings.setValue("maxBoardValue", 198);
     } else if(difficulty == "Custom") {
+        settings.setValue("minBoardValue", 0);
+        settings.setValue("maxBoardValue", 0);
         SettingsDialog dialog = SettingsDialog(this);
         dialog.exec();
     }
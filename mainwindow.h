@@ -9,6 +9,8 @@
 #include "minefieldmodel.h"
 #include "minefielddelegate.h"
 #include "gameboard.h"
+#include "gamestatistics.h"
+#include "archivedboard.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -19,7 +21,7 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    MainWindow(QWidget *parent = nullptr, const QString &statisticsDirectory = QString());
     ~MainWindow();
     bool event(QEvent *event) override;//Used to handle resize events
 
@@ -30,6 +32,11 @@ private:
     QTimer *clockUpdateTimer;
     QElapsedTimer gameTimer;
 
+    //History of finished games
+    GameStatistics statistics;
+    QVector<ArchivedBoard> finishedGames;
+    static const int MAX_FINISHED_GAMES = 500;
+
     //Minefield model
     MinefieldModel *minefield;
     MinefieldDelegate *delegate;
@@ -43,6 +50,12 @@ private:
     int gameRows;
     int gameCols;
     int mineCount;
+    int minBoardValue;
+    int maxBoardValue;
+    int revealBudget;
+    bool animateReveal;
+    QString topologyName;
+    bool forgiving;
     static const int MIN_CELL_SIZE = 20;
     static const int MAX_CELL_SIZE = 80;
 
@@ -61,8 +74,11 @@ public slots:
     void resetGame();
     void startGame();
     void helpMessage();
+    void memoryReport();
+    void reviewGames();
     void updateClockDisplay();
     void updateMineCountDisplay(int mineCountDisplay);
+    void setForgivingMode(bool enabled);
 
 private slots:
     void on_difficultyComboBox_activated(int index);
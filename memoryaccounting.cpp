@@ -0,0 +1,96 @@
+#include "memoryaccounting.h"
+#include <QTextStream>
+#include <cstdio>
+
+
+bool MemoryAccounting::enabled = false;
+MemoryAccounting::Counters MemoryAccounting::counters[MemoryAccounting::SubsystemCount];
+QAtomicInteger<qint64> MemoryAccounting::cellCount;
+
+void MemoryAccounting::setEnabled(bool enabled)
+{
+    MemoryAccounting::enabled = enabled;
+}
+
+void MemoryAccounting::allocated(Subsystem subsystem, qint64 bytes)
+{
+    if(!enabled || bytes <= 0) return;
+    Counters &counter = counters[subsystem];
+    counter.allocations.fetchAndAddRelaxed(1);
+    counter.bytes.fetchAndAddRelaxed(bytes);
+    qint64 current = counter.current.fetchAndAddRelaxed(bytes) + bytes;
+
+    //Raise the peak unless another thread already raised it further
+    qint64 peak = counter.peak.loadRelaxed();
+    while(current > peak && !counter.peak.testAndSetRelaxed(peak, current, peak)) {
+    }
+}
+
+void MemoryAccounting::released(Subsystem subsystem, qint64 bytes)
+{
+    if(!enabled || bytes <= 0) return;
+    counters[subsystem].current.fetchAndSubRelaxed(bytes);
+}
+
+void MemoryAccounting::setCellCount(qint64 cells)
+{
+    if(enabled) cellCount.storeRelaxed(cells);
+}
+
+QString MemoryAccounting::report()
+{
+    const char *names[SubsystemCount] = {"MinefieldModel", "MinefieldDelegate", "Gameboard", "Generation", "ArchivedBoards"};
+    QString output;
+    QTextStream stream(&output);
+
+    stream << "Memory accounting\n";
+    stream << qSetFieldWidth(20) << Qt::left << "subsystem" << qSetFieldWidth(14) << Qt::right
+           << "allocations" << "total bytes" << "current" << "peak" << qSetFieldWidth(0) << "\n";
+    for(int i = 0; i < SubsystemCount; ++i) {
+        stream << qSetFieldWidth(20) << Qt::left << names[i] << qSetFieldWidth(14) << Qt::right
+               << counters[i].allocations.loadRelaxed() << counters[i].bytes.loadRelaxed()
+               << counters[i].current.loadRelaxed() << counters[i].peak.loadRelaxed() << qSetFieldWidth(0) << "\n";
+    }
+
+    //Footprint of the live board per cell
+    qint64 cells = cellCount.loadRelaxed();
+    if(cells > 0) {
+        stream << "Model bytes per cell: " << QString::number(double(counters[Model].current.loadRelaxed()) / cells, 'f', 2) << "\n";
+    }
+
+    return output;
+}
+
+void MemoryAccounting::dump()
+{
+    if(!enabled) return;
+    QTextStream(stderr) << report();
+}
+
+ScopedAllocation::ScopedAllocation(MemoryAccounting::Subsystem subsystem, qint64 bytes) :
+    subsystem(subsystem), bytes(bytes)
+{
+    MemoryAccounting::allocated(subsystem, bytes);
+}
+
+ScopedAllocation::~ScopedAllocation()
+{
+    MemoryAccounting::released(subsystem, bytes);
+}
+
+void ScopedAllocation::grow(qint64 bytes)
+{
+    if(bytes <= this->bytes) return;
+    MemoryAccounting::allocated(subsystem, bytes - this->bytes);
+    this->bytes = bytes;
+}
+
+void ScopedAllocation::set(qint64 bytes)
+{
+    if(bytes > this->bytes) {
+        MemoryAccounting::allocated(subsystem, bytes - this->bytes);
+    } else {
+        MemoryAccounting::released(subsystem, this->bytes - bytes);
+    }
+    this->bytes = bytes;
+}
@@ -0,0 +1,54 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+//Opt-in counters for where memory goes, off unless enabled at startup
+class MemoryAccounting
+{
+public:
+    enum Subsystem { Model,
+                     Delegate,
+                     Gameboard,
+                     Generation,
+                     Archive,
+                     SubsystemCount };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+    static void allocated(Subsystem subsystem, qint64 bytes);
+    static void released(Subsystem subsystem, qint64 bytes);
+    static void setCellCount(qint64 cells);
+    static QString report();
+    static void dump();
+
+private:
+    struct Counters {
+        QAtomicInteger<qint64> allocations,
+                               bytes,
+                               current,
+                               peak;
+    };
+
+    static bool enabled;
+    static Counters counters[SubsystemCount];
+    static QAtomicInteger<qint64> cellCount;
+};
+
+//Accounts a buffer for as long as it is in scope, grow() follows a container as it expands
+//and set() follows one that also drains
+class ScopedAllocation
+{
+private:
+    MemoryAccounting::Subsystem subsystem;
+    qint64 bytes;
+
+public:
+    ScopedAllocation(MemoryAccounting::Subsystem subsystem, qint64 bytes = 0);
+    ~ScopedAllocation();
+    void grow(qint64 bytes);
+    void set(qint64 bytes);
+};
+
+#endif // MEMORYACCOUNTING_H
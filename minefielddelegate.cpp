@@ -1,9 +1,10 @@
 #include "minefielddelegate.h"
 #include "minefieldmodel.h"
+#include "memoryaccounting.h"
 #include <QPainter>
 
 
-MinefieldDelegate::MinefieldDelegate(QObject *parent) : QStyledItemDelegate(parent)
+MinefieldDelegate::MinefieldDelegate(QObject *parent) : QStyledItemDelegate(parent), pixmapBytes(0)
 {
     //Load background pixmaps
     minePixmap = QPixmap(QString(":/images/mine.png"));
@@ -13,6 +14,23 @@ MinefieldDelegate::MinefieldDelegate(QObject *parent) : QStyledItemDelegate(pare
     for(int i = 0; i <= 8; ++i) {
         cellNumbers.push_back(QPixmap(":/images/cell_" + QString::number(i) + ".png"));
     }
+
+    //Account the loaded images
+    pixmapBytes = bytesOf(minePixmap) + bytesOf(mineRedPixmap) + bytesOf(flagPixmap) + bytesOf(cellClosedPixmap);
+    for(const QPixmap &pixmap : cellNumbers) {
+        pixmapBytes += bytesOf(pixmap);
+    }
+    MemoryAccounting::allocated(MemoryAccounting::Delegate, pixmapBytes);
+}
+
+MinefieldDelegate::~MinefieldDelegate()
+{
+    MemoryAccounting::released(MemoryAccounting::Delegate, pixmapBytes);
+}
+
+qint64 MinefieldDelegate::bytesOf(const QPixmap &pixmap)
+{
+    return static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
 }
 
 void MinefieldDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
@@ -24,6 +42,9 @@ void MinefieldDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opt
     int mineCount = index.data(MinefieldModel::MineCountRole).toInt();
     QSize cellSize(option.rect.width(), option.rect.height());
 
+    //Every paint makes a scaled copy of the cell image
+    ScopedAllocation scaledCopy(MemoryAccounting::Delegate, static_cast<qint64>(cellSize.width()) * cellSize.height() * 4);
+
     painter->save();
 
     //Set brush to paint cell
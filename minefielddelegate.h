@@ -9,6 +9,7 @@ class MinefieldDelegate : public QStyledItemDelegate
     Q_OBJECT
 public:
     explicit MinefieldDelegate(QObject *parent = nullptr);
+    ~MinefieldDelegate();
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 
 private:
@@ -18,6 +19,9 @@ private:
             flagPixmap,
             cellClosedPixmap;
     QVector<QPixmap> cellNumbers;
+    qint64 pixmapBytes;
+
+    static qint64 bytesOf(const QPixmap &pixmap);
 };
 
 #endif // MINEFIELDDELEGATE_H
@@ -1,24 +1,69 @@
 #include "minefieldmodel.h"
-#include <QRandomGenerator>
-#include <QStack>
+#include "zobrist.h"
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <cmath>
+#include <functional>
 
 
-MinefieldModel::MinefieldModel(int rows, int columns, int mineCount, QObject *parent) : QAbstractTableModel(parent),
-    rows(rows), columns(columns), mineCount(mineCount), mineDisplayCount(mineCount), cellsClosed(rows * columns)
+//Draw how many of `draws` cells get a mine when `successes` mines are spread over `population` cells
+static qint64 sampleHypergeometric(qint64 population, qint64 successes, qint64 draws, QRandomGenerator &generator)
 {
-    //Fill minefield with cells
-    for(int i = 0; i < rows; ++i) {
-        cells.push_back(QVector<Cell *>(columns));
-        for(int j = 0; j < columns; ++j) {
-            cells[i][j] = new Cell();
+    qint64 failures = population - successes;
+    qint64 low = qMax<qint64>(0, draws - failures), high = qMin(draws, successes);
+    if(low >= high) return low;
+
+    //Start at the mode then walk outward using pmf ratios, expected steps are about one standard deviation
+    qint64 mode = qBound(low, static_cast<qint64>((draws + 1.0) * (successes + 1.0) / (population + 2.0)), high);
+    auto logChoose = [](qint64 n, qint64 k) {
+        return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+    };
+    double pMode = std::exp(logChoose(successes, mode) + logChoose(failures, draws - mode) - logChoose(population, draws));
+
+    double u = generator.generateDouble() - pMode;
+    if(u <= 0) return mode;
+
+    qint64 below = mode, above = mode;
+    double pBelow = pMode, pAbove = pMode;
+    while(below > low || above < high) {
+        if(above < high) {
+            pAbove *= static_cast<double>(successes - above) * (draws - above) / (static_cast<double>(above + 1) * (failures - draws + above + 1));
+            ++above;
+            u -= pAbove;
+            if(u <= 0) return above;
+        }
+        if(below > low) {
+            pBelow *= static_cast<double>(below) * (failures - draws + below) / (static_cast<double>(successes - below + 1) * (draws - below + 1));
+            --below;
+            u -= pBelow;
+            if(u <= 0) return below;
         }
     }
+
+    //Only reached through rounding error
+    return mode;
+}
+
+
+MinefieldModel::MinefieldModel(int rows, int columns, int mineCount, QObject *parent) : QAbstractTableModel(parent),
+    rows(rows), columns(columns), mineCount(mineCount), mineDisplayCount(mineCount), cellsClosed(rows * columns),
+    clickCount(0), boardValue(0), minBoardValue(0), maxBoardValue(0), seed(QRandomGenerator::global()->generate()), firstClick(-1), boardHash(0),
+    cells(rows * columns), topology(nullptr), forgiving(false), lossUnproven(false), solver(cells, adjacency),
+    pendingRevealsAllocation(MemoryAccounting::Model), revealTimer(new QTimer(this)), revealBudget(0), startNewFill(false), revealAnimated(false), gameEnded(false), pendingGameWon(false)
+{
+    revealTimer->setInterval(REVEAL_FRAME_INTERVAL);
+    connect(revealTimer, &QTimer::timeout, this, &MinefieldModel::streamReveals);
+
+    MemoryAccounting::allocated(MemoryAccounting::Model, cells.capacity() * sizeof(Cell));
+    MemoryAccounting::setCellCount(cells.size());
+
+    //Classic square board unless told otherwise
+    setTopology(new SquareTopology());
 }
 
 MinefieldModel::~MinefieldModel() {
-    for(int i = 0; i < cells.size(); ++i) {
-        qDeleteAll(cells[i]);
-    }
+    MemoryAccounting::released(MemoryAccounting::Model, cells.capacity() * sizeof(Cell) + adjacencyBytes());
+    delete topology;
 }
 
 int MinefieldModel::rowCount(const QModelIndex &parent) const
@@ -38,16 +83,16 @@ QVariant MinefieldModel::data(const QModelIndex &index, int role) const
     Q_UNUSED(index);
     Q_UNUSED(role);
 
-    Cell *currentCell = cells[index.row()][index.column()];
+    const Cell &currentCell = cells[index.row() * columns + index.column()];
 
-    if(role == MinefieldModel::OpenStatusRole) {
-        return currentCell->isStatusFlagSet(Cell::Opened);
+    if(role == MinefieldModel::OpenStatusRole) {//Cells waiting to be streamed still look closed
+        return currentCell.isStatusFlagSet(Cell::Opened) && !currentCell.isStatusFlagSet(Cell::Pending);
     } else if(role == MinefieldModel::MineStatusRole) {
-        return currentCell->isStatusFlagSet(Cell::HasMine);
+        return currentCell.isStatusFlagSet(Cell::HasMine);
     } else if(role == MinefieldModel::FlagStatusRole) {
-        return currentCell->isStatusFlagSet(Cell::Flagged);
+        return currentCell.isStatusFlagSet(Cell::Flagged);
     } else if(role == MinefieldModel::MineCountRole) {
-        return currentCell->getMinesAdjacent();
+        return currentCell.getMinesAdjacent();
     }
 
     return QVariant();
@@ -57,151 +102,620 @@ bool MinefieldModel::setData(const QModelIndex &index, const QVariant &value, in
 {
     Q_UNUSED(value);
 
+    //Board takes no more moves once won or lost, even while the last reveal streams out
+    if(gameEnded) return false;
+    compileAdjacency();
+
     //Get cell clicked on in model
-    Cell *currentCell = cells[index.row()][index.column()];
+    int cell = index.row() * columns + index.column();
+    Cell &currentCell = cells[cell];
+    ++clickCount;
 
     //Handle flagging and opening rolls
     if(role == MinefieldModel::FlagStatusRole) {//Attempt to flag cell
-        if(!currentCell->isStatusFlagSet(Cell::Opened)) {//Do not do any flagging if cell open
-            if(currentCell->isStatusFlagSet(Cell::Flagged)) {
-                currentCell->clearStatusFlag(Cell::Flagged);
+        if(!currentCell.isStatusFlagSet(Cell::Opened)) {//Do not do any flagging if cell open
+            if(currentCell.isStatusFlagSet(Cell::Flagged)) {
+                currentCell.clearStatusFlag(Cell::Flagged);
                 ++mineDisplayCount;
             } else {
-                currentCell->setStatusFlag(Cell::Flagged);
+                currentCell.setStatusFlag(Cell::Flagged);
                 --mineDisplayCount;
             }
+            boardHash ^= Zobrist::key(cell, Cell::Flagged);
 
             //Notify
             emit mineDisplayUpdated(mineDisplayCount);
             emit dataChanged(index, index);
         }
     } else if(role == MinefieldModel::OpenStatusRole) {//Attempt to open cell
-        if(!currentCell->isStatusFlagSet(Cell::Flagged)) {//Do not open if cell flagged or open
+        if(!currentCell.isStatusFlagSet(Cell::Flagged)) {//Do not open if cell flagged or open
+            //A guess onto a mine may be forgiven before the cell opens
+            if(forgiving && !currentCell.isStatusFlagSet(Cell::Opened) && currentCell.isStatusFlagSet(Cell::HasMine)) {
+                forgiveMine(cell);
+            }
+
             //Open and mark changed
-            if(!currentCell->isStatusFlagSet(Cell::Opened)) --cellsClosed;
-            currentCell->setStatusFlag(Cell::Opened);
+            if(!currentCell.isStatusFlagSet(Cell::Opened)) {
+                --cellsClosed;
+                boardHash ^= Zobrist::key(cell, Cell::Opened);
+            }
+            currentCell.setStatusFlag(Cell::Opened);
             emit dataChanged(index, index);
 
             //Check for mine, else attempt floodfill
-            if(currentCell->isStatusFlagSet(Cell::HasMine)) {
-                emit gameOver(false);
+            if(currentCell.isStatusFlagSet(Cell::HasMine)) {
+                finishGame(false);
                 return true;
             } else {
-                floodFill(index);
+                //The first frame's worth of a new fill is shown straight away, only the rest waits for the timer
+                int queuedFills = pendingFills.size();
+                floodFill(cell);
+                if(pendingFills.size() > queuedFills) streamNewFill();
             }
 
             //Game win condition
-            if(cellsClosed == mineCount) emit gameOver(true);
+            if(cellsClosed == mineCount) finishGame(true);
         }
     }
 
     return true;
 }
 
+quint32 MinefieldModel::getSeed() const
+{
+    return seed;
+}
+
+void MinefieldModel::setSeed(quint32 seed)
+{
+    //Only affects boards not yet generated
+    this->seed = seed;
+}
+
+int MinefieldModel::getFirstClick() const
+{
+    return firstClick;
+}
+
+int MinefieldModel::getClickCount() const
+{
+    return clickCount;
+}
+
+int MinefieldModel::getBoardValue() const
+{
+    return boardValue;
+}
+
+void MinefieldModel::setBoardValueRange(int minimum, int maximum)
+{
+    //A maximum of zero leaves the range unbounded above
+    minBoardValue = minimum;
+    maxBoardValue = maximum;
+}
+
+void MinefieldModel::setTopology(BoardTopology *topology)
+{
+    //Takes ownership, the neighbour relation is compiled when the board is first used
+    delete this->topology;
+    this->topology = topology;
+    MemoryAccounting::released(MemoryAccounting::Model, adjacencyBytes());
+    adjacency = BoardTopology::Adjacency();
+}
+
+void MinefieldModel::compileAdjacency()
+{
+    //Once per board, whichever topology was set last
+    if(!adjacency.offsets.isEmpty()) return;
+    adjacency = topology->compile(rows, columns);
+    MemoryAccounting::allocated(MemoryAccounting::Model, adjacencyBytes());
+}
+
+const BoardTopology *MinefieldModel::getTopology() const
+{
+    return topology;
+}
+
+void MinefieldModel::setForgiving(bool forgiving)
+{
+    this->forgiving = forgiving;
+}
+
+bool MinefieldModel::isLossUnproven() const
+{
+    return lossUnproven;
+}
+
+qint64 MinefieldModel::adjacencyBytes() const
+{
+    return adjacency.offsets.capacity() * static_cast<qint64>(sizeof(qsizetype)) + adjacency.neighbours.capacity() * static_cast<qint64>(sizeof(int));
+}
+
+quint64 MinefieldModel::getBoardHash() const
+{
+    return boardHash;
+}
+
+ArchivedBoard MinefieldModel::archive(bool gameWon) const
+{
+    return ArchivedBoard(rows, columns, cells, *topology, gameWon, boardHash);
+}
+
+bool MinefieldModel::forgiveMine(int cell)
+{
+    //Find another layout that matches every number on show with this cell safe, none means it was a sure mine
+    MinefieldSolver::Relocation relocation;
+    MinefieldSolver::Result result = solver.relocateMine(cell, relocation, relocationGenerator);
+    if(result != MinefieldSolver::Relocated) {
+        //A search that gave up leaves the mine in place but the guess is reported as unforgiven, not certain
+        lossUnproven = (result == MinefieldSolver::GaveUp);
+        return false;
+    }
+
+    //Update counts around each moved mine instead of recounting the board
+    for(int moved : relocation.cleared) {
+        cells[moved].clearStatusFlag(Cell::HasMine);
+        boardHash ^= Zobrist::key(moved, Cell::HasMine);
+        for(const int *n = adjacency.begin(moved), *end = adjacency.end(moved); n != end; ++n) {
+            if(!cells[*n].isStatusFlagSet(Cell::HasMine)) cells[*n].setMinesAdjacent(cells[*n].getMinesAdjacent() - 1);
+        }
+    }
+    for(int moved : relocation.mined) {
+        cells[moved].setStatusFlag(Cell::HasMine);
+        boardHash ^= Zobrist::key(moved, Cell::HasMine);
+        cells[moved].setMinesAdjacent(0);
+        for(const int *n = adjacency.begin(moved), *end = adjacency.end(moved); n != end; ++n) {
+            if(!cells[*n].isStatusFlagSet(Cell::HasMine)) cells[*n].setMinesAdjacent(cells[*n].getMinesAdjacent() + 1);
+        }
+    }
+
+    //Cells that lost a mine were never counted
+    for(int moved : relocation.cleared) {
+        cells[moved].setMinesAdjacent(countStatusNear(moved, Cell::HasMine));
+    }
+
+    boardValue = computeBoardValue();
+    return true;
+}
+
 void MinefieldModel::populateMines(int clickedRow, int clickedCol)
 {
+    firstClick = clickedRow * columns + clickedCol;
+    compileAdjacency();
+
+    //Every attempt has its own seed, the accepted one replaces the game seed so replaying needs no 3BV range
+    QRandomGenerator attemptSeeds(seed);
+    quint32 attemptSeed = seed;
+
+    //Regenerate until the 3BV is in range, give up after a while so impossible ranges still get a board
+    for(int attempt = 1; ; ++attempt) {
+        QRandomGenerator generator(attemptSeed);
+        if(cells.size() >= PARALLEL_GENERATION_THRESHOLD) {
+            placeMinesTiled(clickedRow, clickedCol, generator);
+        } else {
+            placeMines(clickedRow, clickedCol, generator);
+        }
+        countAdjacentMines();
+        boardValue = computeBoardValue();
+
+        bool inRange = boardValue >= minBoardValue && (maxBoardValue <= 0 || boardValue <= maxBoardValue);
+        if(inRange || attempt >= MAX_GENERATION_ATTEMPTS) break;
+        attemptSeed = attemptSeeds.generate();
+    }
+    seed = attemptSeed;
+    relocationGenerator.seed(seed ^ 0x9E3779B9u);
+
+    //Hash the finished layout once, later changes update it a cell at a time
+    boardHash = computeBoardHash();
+}
+
+void MinefieldModel::placeMines(int clickedRow, int clickedCol, QRandomGenerator &generator)
+{
+    //Clear any previous attempt
+    for(Cell &cell : cells) {
+        cell.clearStatusFlag(Cell::HasMine);
+        cell.setMinesAdjacent(0);
+    }
+
     //Represent 2D minefield as 1D array of indices
     int size = qMax(1, rows * columns);//Just to quiet debug statments
-    int indices[size];
+    QVector<int> indices(size);
+    ScopedAllocation indicesAllocation(MemoryAccounting::Generation, size * sizeof(int));
     for(int i = 0; i < size; ++i) {
         indices[i] = i;
     }
 
     //Random shuffle indices to choose which have mines
     for(int i = 0; i < 2 * size; ++i) {
-        int a = QRandomGenerator::global()->generate() % (size);
-        int b = QRandomGenerator::global()->generate() % (size);
+        int a = generator.generate() % (size);
+        int b = generator.generate() % (size);
         int tmp = indices[a];
         indices[a] = indices[b];
         indices[b] = tmp;
     }
 
     //Choose first mineCount indices to have mines
+    int clicked = clickedRow * columns + clickedCol;
     for(int i = 0, lim = mineCount; i < lim; ++i) {
-        int curRow = indices[i] / columns, curCol = indices[i] % columns;
-
         //Increase limit by one and continue to not have first click be mine
-        if(curRow == clickedRow && curCol == clickedCol) {
+        if(indices[i] == clicked) {
             ++lim;
             continue;
         }
-        cells[curRow][curCol]->setStatusFlag(Cell::HasMine);
+        cells[indices[i]].setStatusFlag(Cell::HasMine);
     }
+}
 
-    //Count adjacent mines for each cell
-    for(int i = 0; i < rows; ++i) {
-        for(int j = 0; j < columns; ++j) {
-            //If has mine do not bother counting adjacent mines
-            if(!cells[i][j]->isStatusFlagSet(Cell::HasMine))
-                cells[i][j]->setMinesAdjacent(this->countStatusNear(this->index(i, j), Cell::HasMine));
+void MinefieldModel::placeMinesTiled(int clickedRow, int clickedCol, QRandomGenerator &generator)
+{
+    struct Tile {
+        int firstRow,
+            lastRow,
+            firstCol,
+            lastCol,
+            mines;
+        quint32 seed;//QRandomGenerator takes a 32 bit seed
+    };
+
+    //Cut the board into square tiles
+    QVector<Tile> tiles;
+    for(int i = 0; i < rows; i += GENERATION_TILE_SIZE) {
+        for(int j = 0; j < columns; j += GENERATION_TILE_SIZE) {
+            tiles.push_back({i, qMin(rows, i + GENERATION_TILE_SIZE), j, qMin(columns, j + GENERATION_TILE_SIZE), 0, 0});
         }
     }
+
+    //Split the mines between tiles with sequential hypergeometric draws, the exact multivariate
+    //hypergeometric split, so the board is as uniform as one shuffled placement
+    int clicked = clickedRow * columns + clickedCol;
+    qint64 cellsLeft = static_cast<qint64>(rows) * columns - 1, minesLeft = mineCount;
+    for(Tile &tile : tiles) {
+        qint64 eligible = static_cast<qint64>(tile.lastRow - tile.firstRow) * (tile.lastCol - tile.firstCol);
+        if(clickedRow >= tile.firstRow && clickedRow < tile.lastRow && clickedCol >= tile.firstCol && clickedCol < tile.lastCol) --eligible;
+
+        tile.mines = static_cast<int>(sampleHypergeometric(cellsLeft, minesLeft, eligible, generator));
+        tile.seed = generator.generate();
+        cellsLeft -= eligible;
+        minesLeft -= tile.mines;
+    }
+
+    //Place each tile's mines independently, selection sampling keeps every subset equally likely
+    Cell *cellData = cells.data();
+    int boardColumns = columns;
+    QtConcurrent::blockingMap(tiles, [cellData, boardColumns, clicked](Tile &tile) {
+        QRandomGenerator tileGenerator(tile.seed);
+        qint64 eligible = static_cast<qint64>(tile.lastRow - tile.firstRow) * (tile.lastCol - tile.firstCol);
+        int needed = tile.mines;
+
+        for(int i = tile.firstRow; i < tile.lastRow; ++i) {
+            for(int j = tile.firstCol; j < tile.lastCol; ++j) {
+                int cell = i * boardColumns + j;
+                cellData[cell].clearStatusFlag(Cell::HasMine);
+                cellData[cell].setMinesAdjacent(0);
+                if(cell == clicked) {
+                    --eligible;
+                    continue;
+                }
+
+                if(needed > 0 && tileGenerator.bounded(static_cast<double>(eligible)) < needed) {
+                    cellData[cell].setStatusFlag(Cell::HasMine);
+                    --needed;
+                }
+                --eligible;
+            }
+        }
+    });
 }
 
-int MinefieldModel::countStatusNear(const QModelIndex &index, Cell::CellStatus status) const
+QVector<QPair<int, int>> MinefieldModel::cellBands() const
 {
-    int count = 0, offset[3] = {-1, 0, 1};
+    //Half open ranges of whole rows, a single range below the parallel threshold
+    QVector<QPair<int, int>> bands;
+    int size = cells.size();
+    int bandSize = (size < PARALLEL_GENERATION_THRESHOLD) ? qMax(1, size) : GENERATION_TILE_SIZE * columns;
+    for(int first = 0; first < size; first += bandSize) {
+        bands.push_back({first, qMin(size, first + bandSize)});
+    }
+    return bands;
+}
 
+void MinefieldModel::countAdjacentMines()
+{
+    //Count adjacent mines for each cell, a band of rows at a time on large boards
+    Cell *cellData = cells.data();
+    auto countRange = [this, cellData](const QPair<int, int> &band) {
+        for(int i = band.first; i < band.second; ++i) {
+            //If has mine do not bother counting adjacent mines
+            if(!cellData[i].isStatusFlagSet(Cell::HasMine))
+                cellData[i].setMinesAdjacent(this->countStatusNear(i, Cell::HasMine));
+        }
+    };
+
+    //Mines are final so reading neighbours across band edges is safe, each band only writes its own counts
+    QVector<QPair<int, int>> bands = cellBands();
+    if(bands.size() == 1) {
+        countRange(bands.first());
+    } else {
+        QtConcurrent::blockingMap(bands, countRange);
+    }
+}
 
-    for(int i = 0; i < 3; ++i) {
-        for(int j = 0; j < 3; ++j) {
-            QModelIndex adjIndex = this->index(index.row() + offset[i], index.column() + offset[j]);
-            if(adjIndex.isValid() && cells[adjIndex.row()][adjIndex.column()]->isStatusFlagSet(status)) {
-                    ++count;
+int MinefieldModel::computeBoardValue() const
+{
+    //3BV is one click per connected region of zeros plus one per numbered cell no zero region opens
+    struct Band {
+        int first,
+            last,
+            value;
+        QVector<QPair<int, int>> crossings;//Zero pairs joined across into an earlier band
+    };
+
+    int size = cells.size();
+    QVector<int> parent(size, -1);
+    ScopedAllocation parentAllocation(MemoryAccounting::Generation, size * sizeof(int));
+    int *parents = parent.data();
+    auto find = [parents](int x) {
+        while(parents[x] != x) {
+            parents[x] = parents[parents[x]];//Path halving
+            x = parents[x];
+        }
+        return x;
+    };
+    auto isZero = [this](int cell) {
+        return !cells[cell].isStatusFlagSet(Cell::HasMine) && cells[cell].getMinesAdjacent() == 0;
+    };
+
+    QVector<Band> bands;
+    for(const QPair<int, int> &range : cellBands()) {
+        bands.push_back({range.first, range.second, 0, {}});
+    }
+    auto forEachBand = [&bands](const std::function<void(Band &)> &function) {
+        if(bands.size() == 1) {
+            function(bands.first());
+        } else {
+            QtConcurrent::blockingMap(bands, function);
+        }
+    };
+
+    //Each band joins its own zeros in one pass, parents never point outside the band so bands run in parallel
+    forEachBand([this, parents, &find, &isZero](Band &band) {
+        for(int i = band.first; i < band.last; ++i) {
+            if(!isZero(i)) continue;
+            parents[i] = i;
+
+            for(const int *n = adjacency.begin(i), *end = adjacency.end(i); n != end; ++n) {
+                if(*n > i || !isZero(*n)) continue;
+                if(*n < band.first) {
+                    band.crossings.push_back({i, *n});
+                    continue;
+                }
+                int rootA = find(i), rootB = find(*n);
+                if(rootA != rootB) parents[rootA] = rootB;
             }
         }
+    });
+
+    //Links between bands are few, join them one at a time
+    for(const Band &band : bands) {
+        for(const QPair<int, int> &crossing : band.crossings) {
+            int rootA = find(crossing.first), rootB = find(crossing.second);
+            if(rootA != rootB) parents[rootA] = rootB;
+        }
     }
 
-    return count;
+    //Count zero regions by their roots and numbered cells with no zero next to them, read only so bands run in parallel
+    forEachBand([this, parents, &isZero](Band &band) {
+        for(int i = band.first; i < band.last; ++i) {
+            if(cells[i].isStatusFlagSet(Cell::HasMine)) continue;
+
+            if(cells[i].getMinesAdjacent() == 0) {
+                if(parents[i] == i) ++band.value;
+                continue;
+            }
+
+            bool touchesZero = false;
+            for(const int *n = adjacency.begin(i), *end = adjacency.end(i); n != end && !touchesZero; ++n) {
+                touchesZero = isZero(*n);
+            }
+            if(!touchesZero) ++band.value;
+        }
+    });
+
+    int value = 0;
+    for(const Band &band : bands) {
+        value += band.value;
+    }
+    return value;
 }
 
-bool MinefieldModel::indexInBounds(int i, int j) const
+quint64 MinefieldModel::computeBoardHash() const
 {
-    return (i >= 0) && (j >= 0) && (i < rows) && (j < columns);
+    //XOR is order free so every band hashes its own cells
+    struct Band {
+        int first,
+            last;
+        quint64 hash;
+    };
+
+    QVector<Band> bands;
+    for(const QPair<int, int> &range : cellBands()) {
+        bands.push_back({range.first, range.second, 0});
+    }
+    auto hashBand = [this](Band &band) {
+        for(int i = band.first; i < band.last; ++i) {
+            if(cells[i].isStatusFlagSet(Cell::HasMine)) band.hash ^= Zobrist::key(i, Cell::HasMine);
+            if(cells[i].isStatusFlagSet(Cell::Flagged)) band.hash ^= Zobrist::key(i, Cell::Flagged);
+            if(cells[i].isStatusFlagSet(Cell::Opened)) band.hash ^= Zobrist::key(i, Cell::Opened);
+        }
+    };
+    if(bands.size() == 1) {
+        hashBand(bands.first());
+    } else {
+        QtConcurrent::blockingMap(bands, hashBand);
+    }
+
+    quint64 hash = 0;
+    for(const Band &band : bands) {
+        hash ^= band.hash;
+    }
+    return hash;
 }
 
-void MinefieldModel::floodFill(const QModelIndex &index)
+int MinefieldModel::countStatusNear(int cell, Cell::CellStatus status) const
 {
-    int rowIndex = index.row(), colIndex = index.column();
-    Cell *cell = cells[rowIndex][colIndex];
+    int count = 0;
+    for(const int *n = adjacency.begin(cell), *end = adjacency.end(cell); n != end; ++n) {
+        count += cells[*n].isStatusFlagSet(status);
+    }
 
-    //Floodfill possible if cell has no bombs adjacent or bombs adjacent is equal to flags adjacent
-    if(cell->getMinesAdjacent() == 0 || (this->countStatusNear(index, Cell::HasMine) == this->countStatusNear(index, Cell::Flagged))) {
-        int offset[3] = {-1, 0, 1};//Used in double for loop to get all adjacent cells
+    return count;
+}
 
-        //Add clicked cell to dfs stack
-        QStack<QPair<int, int>> dfs;
-        dfs.push({rowIndex, colIndex});
+void MinefieldModel::floodFill(int cell)
+{
+    //Floodfill possible if cell has no bombs adjacent or bombs adjacent is equal to flags adjacent
+    if(cells[cell].getMinesAdjacent() == 0 || (this->countStatusNear(cell, Cell::HasMine) == this->countStatusNear(cell, Cell::Flagged))) {
+        //Add clicked cell to bfs queue, breadth first so reveals spread outward from the click
+        QQueue<RevealStep> bfs;
+        ScopedAllocation bfsAllocation(MemoryAccounting::Model);
+        bfs.enqueue({cell, 0});
+        startNewFill = true;
 
         //While cells to open
-        while(!dfs.empty()) {
-            QPair<int, int> curIndex = dfs.top();
-            dfs.pop();
-
-            //All cells in 3x3 square around cell are adjacent to it
-            for(int i = 0; i < 3; ++i) {
-                for(int j = 0; j < 3; ++j) {
-                    int a = curIndex.first + offset[i], b = curIndex.second + offset[j];
-
-                    //If invalid index skip, if flagged don't open, if open then already visited so skip
-                    if(!indexInBounds(a, b) || cells[a][b]->isStatusFlagSet(Cell::Flagged) || cells[a][b]->isStatusFlagSet(Cell::Opened))
-                        continue;
-
-                    //Set cell as opened and let view know
-                    if(!cells[a][b]->isStatusFlagSet(Cell::Opened)) --cellsClosed;
-                    cells[a][b]->setStatusFlag(Cell::Opened);
-                    emit dataChanged(this->index(a, b), this->index(a, b));
-
-                    //If opening mine, else add to dfs if no adjacent mines
-                    if(cells[a][b]->isStatusFlagSet(Cell::HasMine)) {
-                        emit gameOver(false);
-                        return;
-                    } else if(cells[a][b]->getMinesAdjacent() == 0) {
-                        dfs.push({a, b});
-                    }
+        while(!bfs.empty()) {
+            RevealStep current = bfs.dequeue();
+
+            //Every neighbour from the board topology
+            for(const int *n = adjacency.begin(current.cell), *end = adjacency.end(current.cell); n != end; ++n) {
+                Cell &adjacent = cells[*n];
+
+                //If flagged don't open, if open then already visited so skip
+                if(adjacent.isStatusFlagSet(Cell::Flagged) || adjacent.isStatusFlagSet(Cell::Opened))
+                    continue;
+
+                //Set cell as opened and let view know
+                --cellsClosed;
+                adjacent.setStatusFlag(Cell::Opened);
+                boardHash ^= Zobrist::key(*n, Cell::Opened);
+                revealCell(*n, current.depth + 1);
+
+                //If opening mine, else add to bfs if no adjacent mines
+                if(adjacent.isStatusFlagSet(Cell::HasMine)) {
+                    finishGame(false);
+                    return;
+                } else if(adjacent.getMinesAdjacent() == 0) {
+                    bfs.enqueue({*n, current.depth + 1});
+                    if(MemoryAccounting::isEnabled()) bfsAllocation.grow(bfs.capacity() * sizeof(RevealStep));
                 }
             }
         }
     }
 }
 
+void MinefieldModel::setRevealBudget(int milliseconds, bool animated)
+{
+    //A budget of zero notifies the view of every cell immediately
+    revealBudget = qMax(0, milliseconds);
+    revealAnimated = animated;
+}
+
+bool MinefieldModel::isRevealPending() const
+{
+    return !pendingFills.isEmpty();
+}
+
+void MinefieldModel::revealCell(int cell, int depth)
+{
+    if(revealBudget == 0) {
+        QModelIndex index = this->index(cell / columns, cell % columns);
+        emit dataChanged(index, index);
+        return;
+    }
+
+    //Model state is already final, only hold back the view update
+    cells[cell].setStatusFlag(Cell::Pending);
+    if(startNewFill) {
+        pendingFills.append(PendingFill());
+        startNewFill = false;
+    }
+    pendingFills.last().steps.enqueue({cell, depth});
+    if(MemoryAccounting::isEnabled()) accountPendingReveals();
+}
+
+void MinefieldModel::accountPendingReveals()
+{
+    //Live total of the queues, so drained fills stop counting towards the model
+    qint64 bytes = 0;
+    for(const PendingFill &fill : pendingFills) bytes += fill.steps.capacity() * sizeof(RevealStep);
+    pendingRevealsAllocation.set(bytes);
+}
+
+void MinefieldModel::finishGame(bool gameWon)
+{
+    //Win or loss is only ever decided once
+    if(gameEnded) return;
+    gameEnded = true;
+
+    //Let the reveal finish streaming before announcing the result
+    if(pendingFills.isEmpty()) {
+        emit gameOver(gameWon);
+    } else {
+        pendingGameWon = gameWon;
+    }
+}
+
+bool MinefieldModel::showFill(PendingFill &fill, const QElapsedTimer &frame, int &shown)
+{
+    //Animated reveals show one more ring of the fill each frame
+    ++fill.depth;
+    while(!fill.steps.isEmpty()) {
+        if(revealAnimated && fill.steps.head().depth > fill.depth) break;
+        if((shown++ & 63) == 63 && frame.elapsed() >= revealBudget) return false;
+
+        RevealStep step = fill.steps.dequeue();
+        cells[step.cell].clearStatusFlag(Cell::Pending);
+        QModelIndex index = this->index(step.cell / columns, step.cell % columns);
+        emit dataChanged(index, index);
+    }
+    return true;
+}
+
+void MinefieldModel::streamNewFill()
+{
+    QElapsedTimer frame;
+    frame.start();
+    int shown = 0;
+
+    //Small fills never reach the timer, older fills keep their own pace
+    showFill(pendingFills.last(), frame, shown);
+    if(pendingFills.last().steps.isEmpty()) pendingFills.removeLast();
+    finishStreaming();
+}
+
+void MinefieldModel::streamReveals()
+{
+    QElapsedTimer frame;
+    frame.start();
+
+    //Show queued cells oldest fill first until the frame budget runs out, checking the clock every few cells
+    int shown = 0;
+    bool inTime = true;
+    for(auto fill = pendingFills.begin(); fill != pendingFills.end() && inTime; ) {
+        inTime = showFill(*fill, frame, shown);
+        fill = fill->steps.isEmpty() ? pendingFills.erase(fill) : fill + 1;
+    }
+    finishStreaming();
+}
+
+void MinefieldModel::finishStreaming()
+{
+    if(MemoryAccounting::isEnabled()) accountPendingReveals();
+
+    //Keep the timer running while cells are held back, once done announce any result held back
+    if(!pendingFills.isEmpty()) {
+        if(!revealTimer->isActive()) revealTimer->start();
+    } else {
+        revealTimer->stop();
+        if(gameEnded) emit gameOver(pendingGameWon);
+    }
+}
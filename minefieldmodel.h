@@ -4,7 +4,16 @@
 #include <QAbstractTableModel>
 #include <QVector>
 #include <QColor>
+#include <QRandomGenerator>
+#include <QQueue>
+#include <QPair>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "cell.h"
+#include "boardtopology.h"
+#include "minefieldsolver.h"
+#include "memoryaccounting.h"
+#include "archivedboard.h"
 
 class MinefieldModel : public QAbstractTableModel
 {
@@ -14,12 +23,73 @@ private:
     columns,
     mineCount,
     mineDisplayCount,
-    cellsClosed;
-    QVector<QVector<Cell *>> cells;
+    cellsClosed,
+    clickCount,
+    boardValue,
+    minBoardValue,
+    maxBoardValue;
+    quint32 seed;
+    int firstClick;//Row major cell of the click that generated the board, -1 before then
+    quint64 boardHash;//Zobrist hash of mines, opened and flagged cells
 
-    int countStatusNear(const QModelIndex &index, Cell::CellStatus status) const;
-    bool indexInBounds(int i, int j) const;
-    void floodFill(const QModelIndex &index);
+    //Cells stored row major, neighbours come from the topology's compiled adjacency
+    QVector<Cell> cells;
+    BoardTopology *topology;
+    BoardTopology::Adjacency adjacency;
+
+    //Forgiving mode moves a guessed mine elsewhere when the numbers allow it
+    bool forgiving,
+         lossUnproven;//Solver ran out of time on the losing guess, so it was never shown to be a mine
+    QRandomGenerator relocationGenerator;
+    MinefieldSolver solver;
+
+    //Progressive reveal of large flood fills, cells are streamed to the view a frame at a time
+    struct RevealStep {
+        int cell,
+            depth;//Distance in flood fill steps from the clicked cell
+    };
+
+    //Each flood fill keeps its own rings so one started mid-animation still spreads from its click
+    struct PendingFill {
+        QQueue<RevealStep> steps;
+        int depth = 0;//Rings shown so far
+    };
+    QVector<PendingFill> pendingFills;
+    ScopedAllocation pendingRevealsAllocation;
+    QTimer *revealTimer;
+    int revealBudget;
+    bool startNewFill,
+         revealAnimated,
+         gameEnded,
+         pendingGameWon;
+
+    int countStatusNear(int cell, Cell::CellStatus status) const;
+    void floodFill(int cell);
+    void revealCell(int cell, int depth);
+    bool showFill(PendingFill &fill, const QElapsedTimer &frame, int &shown);
+    void streamNewFill();
+    void finishStreaming();
+    void accountPendingReveals();
+    void finishGame(bool gameWon);
+    void placeMines(int clickedRow, int clickedCol, QRandomGenerator &generator);
+    void placeMinesTiled(int clickedRow, int clickedCol, QRandomGenerator &generator);
+    void compileAdjacency();
+    void countAdjacentMines();
+    int computeBoardValue() const;
+    quint64 computeBoardHash() const;
+    QVector<QPair<int, int>> cellBands() const;
+    bool forgiveMine(int cell);
+    qint64 adjacencyBytes() const;
+
+    //Interval between reveal frames in milliseconds
+    static const int REVEAL_FRAME_INTERVAL = 16;
+
+    //Boards with at least this many cells are generated tile by tile across the thread pool
+    static const int PARALLEL_GENERATION_THRESHOLD = 1 << 20;
+    static const int GENERATION_TILE_SIZE = 256;
+
+    //Regeneration attempts before accepting a board outside the requested 3BV range
+    static const int MAX_GENERATION_ATTEMPTS = 200;
 
 public:
     explicit MinefieldModel(int rows = 5, int columns = 5, int mineCount = 8, QObject *parent = nullptr);
@@ -28,6 +98,20 @@ public:
     int columnCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role) override;
+    quint32 getSeed() const;
+    void setSeed(quint32 seed);
+    int getFirstClick() const;
+    int getClickCount() const;
+    int getBoardValue() const;
+    void setBoardValueRange(int minimum, int maximum);
+    void setRevealBudget(int milliseconds, bool animated = false);
+    bool isRevealPending() const;
+    void setTopology(BoardTopology *topology);
+    const BoardTopology *getTopology() const;
+    void setForgiving(bool forgiving);
+    bool isLossUnproven() const;
+    quint64 getBoardHash() const;
+    ArchivedBoard archive(bool gameWon) const;
 
     enum Role {
         OpenStatusRole = Qt::UserRole + 1,
@@ -39,6 +123,9 @@ public:
 public slots:
     void populateMines(int row, int col);
 
+private slots:
+    void streamReveals();
+
 signals:
     void gameOver(bool gameWon);
     void mineDisplayUpdated(int mineDisplayCount);
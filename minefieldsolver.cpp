@@ -0,0 +1,214 @@
+#include "minefieldsolver.h"
+#include "zobrist.h"
+#include <QHash>
+#include <QQueue>
+
+
+MinefieldSolver::MinefieldSolver(const QVector<Cell> &cells, const BoardTopology::Adjacency &adjacency) :
+    cells(cells), adjacency(adjacency)
+{
+}
+
+bool MinefieldSolver::isClosed(int cell) const
+{
+    return !cells[cell].isStatusFlagSet(Cell::Opened);
+}
+
+bool MinefieldSolver::isOpened(int cell) const
+{
+    return cells[cell].isStatusFlagSet(Cell::Opened);
+}
+
+bool MinefieldSolver::isFrontier(int cell) const
+{
+    //Closed cell next to at least one number the player can see
+    if(!isClosed(cell)) return false;
+    for(const int *n = adjacency.begin(cell), *end = adjacency.end(cell); n != end; ++n) {
+        if(isOpened(*n)) return true;
+    }
+    return false;
+}
+
+MinefieldSolver::Result MinefieldSolver::relocateMine(int target, Relocation &relocation, QRandomGenerator &generator)
+{
+    relocation.cleared.clear();
+    relocation.mined.clear();
+
+    //Split closed cells into the frontier and floating cells nothing constrains
+    QVector<int> floatingMined, floatingEmpty;
+    for(int i = 0, size = cells.size(); i < size; ++i) {
+        if(!isClosed(i) || i == target || isFrontier(i)) continue;
+
+        if(cells[i].isStatusFlagSet(Cell::HasMine)) {
+            floatingMined.push_back(i);
+        } else {
+            floatingEmpty.push_back(i);
+        }
+    }
+
+    //Floating target, just swap with an empty floating cell
+    if(!isFrontier(target)) {
+        if(floatingEmpty.isEmpty()) return NoLayout;
+        relocation.cleared.push_back(target);
+        relocation.mined.push_back(floatingEmpty[generator.bounded(static_cast<int>(floatingEmpty.size()))]);
+        return Relocated;
+    }
+
+    //Only the target's component needs a new layout, every other component keeps its current one
+    Component component = buildComponent(target);
+    Search search;
+    search.component = &component;
+    search.assignment = QVector<int>(component.unknowns.size(), -1);
+    search.assigned = QVector<int>(component.constraints.size(), 0);
+    search.unassigned = QVector<int>(component.constraints.size(), 0);
+    search.target = target;
+    search.currentMines = 0;
+    search.newMines = 0;
+    search.floatingMines = floatingMined.size();
+    search.floatingCells = floatingMined.size() + floatingEmpty.size();
+    search.nodes = 0;
+    search.generator = &generator;
+    search.stateHash = 0;
+    for(int c = 0; c < component.constraints.size(); ++c) {
+        search.unassigned[c] = component.constraintVars[c].size();
+    }
+    for(int u : component.unknowns) {
+        search.currentMines += cells[u].isStatusFlagSet(Cell::HasMine);
+    }
+
+    if(!assign(search, 0)) return (search.nodes > SEARCH_NODE_LIMIT) ? GaveUp : NoLayout;
+
+    //Turn the new assignment into changes
+    int newMines = 0;
+    for(int v = 0; v < component.unknowns.size(); ++v) {
+        int cell = component.unknowns[v];
+        bool mined = cells[cell].isStatusFlagSet(Cell::HasMine);
+        newMines += search.assignment[v];
+        if(mined && !search.assignment[v]) relocation.cleared.push_back(cell);
+        if(!mined && search.assignment[v]) relocation.mined.push_back(cell);
+    }
+
+    //Keep the total mine count by moving the difference through floating cells
+    int delta = newMines - search.currentMines;
+    for(; delta > 0; --delta) {
+        int pick = generator.bounded(static_cast<int>(floatingMined.size()));
+        relocation.cleared.push_back(floatingMined[pick]);
+        floatingMined.removeAt(pick);
+    }
+    for(; delta < 0; ++delta) {
+        int pick = generator.bounded(static_cast<int>(floatingEmpty.size()));
+        relocation.mined.push_back(floatingEmpty[pick]);
+        floatingEmpty.removeAt(pick);
+    }
+
+    return Relocated;
+}
+
+MinefieldSolver::Component MinefieldSolver::buildComponent(int start) const
+{
+    Component component;
+    QHash<int, int> varIndex, constraintIndex;
+
+    //Breadth first from the start cell, alternating closed cells and the numbers touching them
+    QQueue<int> queue;
+    varIndex.insert(start, 0);
+    component.unknowns.push_back(start);
+    queue.enqueue(start);
+    while(!queue.isEmpty()) {
+        int unknown = queue.dequeue();
+        for(const int *n = adjacency.begin(unknown), *end = adjacency.end(unknown); n != end; ++n) {
+            if(!isOpened(*n) || constraintIndex.contains(*n)) continue;
+            constraintIndex.insert(*n, component.constraints.size());
+            component.constraints.push_back(*n);
+
+            for(const int *m = adjacency.begin(*n), *mEnd = adjacency.end(*n); m != mEnd; ++m) {
+                if(!isClosed(*m) || varIndex.contains(*m)) continue;
+                varIndex.insert(*m, component.unknowns.size());
+                component.unknowns.push_back(*m);
+                queue.enqueue(*m);
+            }
+        }
+    }
+
+    //Wire variables and constraints together
+    component.constraintVars.resize(component.constraints.size());
+    component.varConstraints.resize(component.unknowns.size());
+    component.required.resize(component.constraints.size());
+    for(int c = 0; c < component.constraints.size(); ++c) {
+        int cell = component.constraints[c];
+        component.required[c] = cells[cell].getMinesAdjacent();
+        for(const int *n = adjacency.begin(cell), *end = adjacency.end(cell); n != end; ++n) {
+            if(!isClosed(*n)) continue;
+            int v = varIndex.value(*n);
+            component.constraintVars[c].push_back(v);
+            component.varConstraints[v].push_back(c);
+        }
+    }
+
+    return component;
+}
+
+bool MinefieldSolver::assign(Search &search, int var) const
+{
+    const Component &component = *search.component;
+    if(++search.nodes > SEARCH_NODE_LIMIT) return false;
+
+    //Every variable set, every number satisfied along the way
+    if(var == component.unknowns.size()) return fitsFloating(search);
+
+    //Another order of earlier choices already reached this state and found nothing below it
+    quint64 state = search.stateHash ^ Zobrist::mix((static_cast<quint64>(var) << 32) | static_cast<quint32>(search.newMines));
+    if(search.deadEnds.contains(state)) return false;
+
+    //Target must be safe, others try both values in random order so layouts are sampled
+    int first = search.generator->bounded(2);
+    for(int k = 0; k < 2; ++k) {
+        int value = (k == 0) ? first : 1 - first;
+        if(value == 1 && component.unknowns[var] == search.target) continue;
+
+        //Check each number this cell touches can still be met
+        bool consistent = true;
+        for(int c : component.varConstraints[var]) {
+            int assigned = search.assigned[c] + value, unassigned = search.unassigned[c] - 1;
+            if(assigned > component.required[c] || assigned + unassigned < component.required[c]) consistent = false;
+        }
+        if(!consistent) continue;
+
+        search.assignment[var] = value;
+        search.newMines += value;
+        for(int c : component.varConstraints[var]) {
+            setAssigned(search, c, search.assigned[c] + value);
+            --search.unassigned[c];
+        }
+
+        if(assign(search, var + 1)) return true;
+
+        for(int c : component.varConstraints[var]) {
+            setAssigned(search, c, search.assigned[c] - value);
+            ++search.unassigned[c];
+        }
+        search.newMines -= value;
+        search.assignment[var] = -1;
+        if(search.nodes > SEARCH_NODE_LIMIT) return false;
+    }
+
+    //Only a search that ran to completion proves a dead end, one cut short may still have answers
+    search.deadEnds.insert(state);
+    return false;
+}
+
+void MinefieldSolver::setAssigned(Search &search, int constraint, int assigned) const
+{
+    //Swap the number's old count out of the state hash and the new one in
+    int cell = search.component->constraints[constraint];
+    search.stateHash ^= Zobrist::key(cell, Zobrist::NumberFeature + search.assigned[constraint]) ^
+                        Zobrist::key(cell, Zobrist::NumberFeature + assigned);
+    search.assigned[constraint] = assigned;
+}
+
+bool MinefieldSolver::fitsFloating(const Search &search) const
+{
+    //Floating cells absorb the change in mines so the total stays the same
+    int floatingAfter = search.floatingMines - (search.newMines - search.currentMines);
+    return floatingAfter >= 0 && floatingAfter <= search.floatingCells;
+}
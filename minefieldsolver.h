@@ -0,0 +1,72 @@
+#ifndef MINEFIELDSOLVER_H
+#define MINEFIELDSOLVER_H
+
+#include <QVector>
+#include <QRandomGenerator>
+#include <QSet>
+#include "cell.h"
+#include "boardtopology.h"
+
+//Reasons about closed cells from the numbers showing on opened cells
+class MinefieldSolver
+{
+public:
+    //Mines to take away and mines to add to move to another consistent layout
+    struct Relocation {
+        QVector<int> cleared,
+                     mined;
+    };
+
+    //Running out of search nodes is not proof the target is a mine, so it has its own result
+    enum Result { Relocated,
+                  NoLayout,
+                  GaveUp };
+
+    MinefieldSolver(const QVector<Cell> &cells, const BoardTopology::Adjacency &adjacency);
+    Result relocateMine(int target, Relocation &relocation, QRandomGenerator &generator);
+
+private:
+    const QVector<Cell> &cells;
+    const BoardTopology::Adjacency &adjacency;
+
+    //Search nodes before giving up on a component, bounds the guess latency uilatency measures as forgiving_guess
+    static const int SEARCH_NODE_LIMIT = 200000;
+
+    //Unknown cells tied together through shared numbers
+    struct Component {
+        QVector<int> unknowns,
+                     constraints;
+        QVector<QVector<int>> constraintVars,
+                              varConstraints;
+        QVector<int> required;
+    };
+
+    struct Search {
+        const Component *component;
+        QVector<int> assignment,
+                     assigned,
+                     unassigned;
+        int target,
+            currentMines,
+            newMines,
+            floatingMines,
+            floatingCells,
+            nodes;
+        QRandomGenerator *generator;
+
+        //Zobrist hash of every number's assigned mine count, with the depth and mines so far it
+        //decides whether the rest of the search can succeed, so a dead end is never searched twice
+        quint64 stateHash;
+        QSet<quint64> deadEnds;
+    };
+
+    bool isClosed(int cell) const;
+    bool isOpened(int cell) const;
+    bool isFrontier(int cell) const;
+    Component buildComponent(int start) const;
+    bool assign(Search &search, int var) const;
+    bool fitsFloating(const Search &search) const;
+    void setAssigned(Search &search, int constraint, int assigned) const;
+};
+
+#endif // MINEFIELDSOLVER_H
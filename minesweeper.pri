@@ -0,0 +1,43 @@
+# Game sources shared by the application and the benchmarks, everything except main.cpp
+
+QT += concurrent
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/archivedboard.cpp \
+    $$PWD/boardtopology.cpp \
+    $$PWD/botcontroller.cpp \
+    $$PWD/cell.cpp \
+    $$PWD/gameboard.cpp \
+    $$PWD/gamestatistics.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/memoryaccounting.cpp \
+    $$PWD/minefielddelegate.cpp \
+    $$PWD/minefieldmodel.cpp \
+    $$PWD/minefieldsolver.cpp \
+    $$PWD/reviewdialog.cpp \
+    $$PWD/settingsdialog.cpp
+
+HEADERS += \
+    $$PWD/archivedboard.h \
+    $$PWD/boardtopology.h \
+    $$PWD/botcontroller.h \
+    $$PWD/cell.h \
+    $$PWD/gameboard.h \
+    $$PWD/gamestatistics.h \
+    $$PWD/mainwindow.h \
+    $$PWD/memoryaccounting.h \
+    $$PWD/minefielddelegate.h \
+    $$PWD/minefieldmodel.h \
+    $$PWD/minefieldsolver.h \
+    $$PWD/reviewdialog.h \
+    $$PWD/settingsdialog.h \
+    $$PWD/zobrist.h
+
+FORMS += \
+    $$PWD/mainwindow.ui \
+    $$PWD/settingsdialog.ui
+
+RESOURCES += \
+    $$PWD/resources.qrc
@@ -0,0 +1,61 @@
+#include "reviewdialog.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+
+
+ReviewDialog::ReviewDialog(const QVector<ArchivedBoard> &games, QWidget *parent) : QDialog(parent),
+    games(games), delegate(new MinefieldDelegate(this))
+{
+    QHBoxLayout *layout = new QHBoxLayout(this);
+
+    //Newest game on the left, the one before it on the right
+    for(int pane = 0; pane < 2; ++pane) {
+        QVBoxLayout *column = new QVBoxLayout();
+        pickers[pane] = new QComboBox(this);
+        for(int i = games.size() - 1; i >= 0; --i) {
+            const ArchivedBoard &game = games[i];
+            pickers[pane]->addItem(QString("Game %0: %1 x %2, %3 Mines, %4").arg(i + 1).arg(game.rowCount())
+                                   .arg(game.columnCount()).arg(game.getMineCount()).arg(game.isWon() ? "Won" : "Lost"), i);
+        }
+
+        //Board only renders what is visible, scroll around large games
+        boards[pane] = new Gameboard(this);
+        boards[pane]->disableView();
+        boards[pane]->setItemDelegate(delegate);
+        boards[pane]->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+        boards[pane]->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+        boards[pane]->horizontalHeader()->setDefaultSectionSize(REVIEW_CELL_SIZE);
+        boards[pane]->verticalHeader()->setDefaultSectionSize(REVIEW_CELL_SIZE);
+        boards[pane]->horizontalHeader()->setMinimumSectionSize(REVIEW_CELL_SIZE);
+        boards[pane]->verticalHeader()->setMinimumSectionSize(REVIEW_CELL_SIZE);
+
+        column->addWidget(pickers[pane]);
+        column->addWidget(boards[pane]);
+        layout->addLayout(column);
+
+        if(pickers[pane]->count() > 0) {
+            int item = qMin(pane, pickers[pane]->count() - 1);
+            pickers[pane]->setCurrentIndex(item);
+            showGame(pane, pickers[pane]->itemData(item).toInt());
+        }
+        connect(pickers[pane], QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, pane](int item) {
+            showGame(pane, pickers[pane]->itemData(item).toInt());
+        });
+    }
+
+    this->setWindowTitle("Review Games");
+}
+
+void ReviewDialog::showGame(int pane, int game)
+{
+    if(game < 0 || game >= games.size()) return;
+
+    //Replace the old model, the view keeps no other reference to it
+    QAbstractItemModel *old = boards[pane]->model();
+    boards[pane]->setModel(new ArchivedBoardModel(games[game], boards[pane]));
+    if(old != nullptr) old->deleteLater();
+
+    QSize size(games[game].columnCount() * REVIEW_CELL_SIZE + 2, games[game].rowCount() * REVIEW_CELL_SIZE + 2);
+    boards[pane]->setMinimumSize(size.boundedTo(QSize(MAX_PANE_SIZE, MAX_PANE_SIZE)));
+}
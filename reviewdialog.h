@@ -0,0 +1,31 @@
+#ifndef REVIEWDIALOG_H
+#define REVIEWDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include <QComboBox>
+#include "archivedboard.h"
+#include "gameboard.h"
+#include "minefielddelegate.h"
+
+//Shows two finished games side by side, each picked from the archive
+class ReviewDialog : public QDialog
+{
+    Q_OBJECT
+private:
+    const QVector<ArchivedBoard> &games;
+    MinefieldDelegate *delegate;
+    QComboBox *pickers[2];
+    Gameboard *boards[2];
+
+    static const int REVIEW_CELL_SIZE = 20;
+    static const int MAX_PANE_SIZE = 600;
+
+public:
+    explicit ReviewDialog(const QVector<ArchivedBoard> &games, QWidget *parent = nullptr);
+
+private slots:
+    void showGame(int pane, int game);
+};
+
+#endif // REVIEWDIALOG_H
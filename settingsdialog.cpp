@@ -1,5 +1,6 @@
 #include "settingsdialog.h"
 #include "ui_settingsdialog.h"
+#include "boardtopology.h"
 #include <QSettings>
 
 
@@ -16,6 +17,7 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
     int gameRows = settings.value("gameRows", 10).toInt();
     int gameCols = settings.value("gameCols", 16).toInt();
     int mineCount = settings.value("mineCount", 20).toInt();
+    QString topology = settings.value("topology", "Square").toString();
     settings.endGroup();
 
     //Apply last settings to ui
@@ -23,6 +25,8 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
     ui->rowSlider->setValue(gameRows);
     ui->columnSlider->setValue(gameCols);
     ui->minesSlider->setValue(mineCount);
+    ui->topologyComboBox->addItems(BoardTopology::windowNames());
+    ui->topologyComboBox->setCurrentText(topology);
     updateMineCountMax();
 
     //Set minimums
@@ -86,6 +90,7 @@ void SettingsDialog::accept()
     settings.setValue("gameRows", ui->rowSlider->value());
     settings.setValue("gameCols", ui->columnSlider->value());
     settings.setValue("mineCount", ui->minesSlider->value());
+    settings.setValue("topology", ui->topologyComboBox->currentText());
     settings.endGroup();
 
     QDialog::accept();
@@ -0,0 +1,30 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <QtGlobal>
+#include "cell.h"
+
+//Zobrist keys for board positions, derived from the cell and feature on demand
+//with a splitmix64 finalizer instead of stored in a table
+namespace Zobrist
+{
+    //Features below 16 are kept for Cell::CellStatus bits, a count n (0 to 26 on cubic boards) is NumberFeature + n
+    enum Feature { NumberFeature = 16 };
+    static_assert(NumberFeature > Cell::Pending, "Zobrist features must not overlap cell status bits");
+    static_assert(NumberFeature + 26 < 64, "Zobrist number features must fit in the six feature bits");
+
+    inline quint64 mix(quint64 x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    inline quint64 key(int cell, int feature)
+    {
+        return mix((static_cast<quint64>(cell) << 6) | static_cast<quint64>(feature & 63));
+    }
+}
+
+#endif // ZOBRIST_H